@@ -4,6 +4,8 @@
 #include "../../models/user.hpp"
 #include "../../models/post.hpp"
 #include "../../models/comment.hpp"
+#include "database/replica_routing.hpp"
+#include "database/statement_cache.hpp"
 
 namespace Admin {
 
@@ -13,16 +15,16 @@ namespace Admin {
         Cyclone::Response index() {
             requireAdmin();
 
-            // Get counts for dashboard
-            auto userCount = User::count();
-            auto postCount = Post::count();
-            auto publishedPostCount = Post::published().count();
-            auto commentCount = Comment::count();
+            // Get counts for dashboard; aggregates tolerate replica lag, so they
+            // stay off the primary even right after an admin edit
+            auto [userCount, postCount, publishedPostCount, commentCount] = Replicas::onReplica([] {
+              return std::tuple{User::count(), Post::count(), Post::published().count(), Comment::count()};
+            });
 
             // Get recent activity
             auto recentUsers = User::orderBy("created_at", "DESC").limit(5).get();
-            auto recentPosts = Post::orderBy("created_at", "DESC").limit(5).get();
-            auto recentComments = Comment::orderBy("created_at", "DESC").limit(5).get();
+            auto recentPosts = includes<User>(Post::orderBy("created_at", "DESC").limit(5));
+            auto recentComments = includes<User, Post>(Comment::orderBy("created_at", "DESC").limit(5));
 
             // Render dashboard view with stats
             return render("admin/dashboard/index", {
@@ -35,6 +37,21 @@ namespace Admin {
               {"recent_comments", recentComments}
             });
         }
+
+        // GET /admin/metrics/statements
+        // Prepared statement cache counters, summed over all pooled connections
+        Cyclone::Response statements() {
+            requireAdmin();
+
+            auto stats = Statements::stats();
+            return Cyclone::Response::json({
+              {"hits", stats.hits},
+              {"misses", stats.misses},
+              {"evictions", stats.evictions},
+              {"bypasses", stats.bypasses},
+              {"hit_rate", stats.hitRate()}
+            });
+        }
     };
 
 } // namespace Admin
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "../application_controller.hpp"
 #include "../../models/post.hpp"
+#include "database/seek_pagination.hpp"
+#include "database/projection.hpp"
 
 namespace Admin {
 
@@ -15,7 +17,7 @@ public:
     auto status = request().params.get<std::string>("status", "all");
     auto author = request().params.get<int>("author_id", 0);
     auto search = request().params.get<std::string>("search", "");
-    auto page = request().params.get<int>("page", 1);
+    auto cursor = request().params.get<std::string>("cursor", "");
     auto perPage = request().params.get<int>("per_page", 20);
 
     // Build query
@@ -39,22 +41,22 @@ public:
       });
     }
 
-    // Order by newest first
-    query = query.orderBy("created_at", "DESC");
+    // Newest first, continuing after the cursor; the planner's estimate
+    // replaces an exact COUNT(*)
+    auto page = seekPaginate(query, cursor, perPage, {.estimateTotal = true});
+    auto& posts = page.items;
+    preload<User>(posts);
 
-    // Paginate results
-    auto paginator = query.paginate(page, perPage);
-
-    // Get authors for filter dropdown
-    auto authors = User::join<Post>()
-      .select("users.id, users.name")
-      .groupBy("users.id")
-      .orderBy("users.name", "ASC")
-      .get();
+    // Get authors for filter dropdown (id and name only, no User models)
+    auto authors = select<UserOption>(
+      User::join<Post>()
+        .groupBy("users.id")
+        .orderBy("users.name", "ASC")
+    );
 
     return render("admin/posts/index", {
-      {"posts", paginator.items()},
-      {"pagination", paginator},
+      {"posts", posts},
+      {"pagination", page.pagination},
       {"status", status},
       {"author_id", author},
       {"search", search},
@@ -149,17 +151,23 @@ public:
     // Check if we're publishing a previously unpublished post
     bool wasPublished = post->published();
 
-    if (post->update(params)) {
+    // The notification job commits with the update (lib/jobs/outbox.hpp)
+    bool updated = false;
+    Cyclone::Database::transaction([&]() {
+      updated = post->update(params);
+
       // If the post was just published, send a notification
-      if (!wasPublished && post->published()) {
-        JobQueue::enqueue<NotificationJob>({
+      if (updated && !wasPublished && post->published()) {
+        NotificationJob::notify({
           .type = NotificationJob::Type::PostPublished,
           .user_id = post->userId(),
           .source_user_id = currentUser()->id(),
           .post_id = post->id()
         });
       }
+    });
 
+    if (updated) {
       flash().notice = "Post was successfully updated";
       return redirectTo("/admin/posts/" + std::to_string(id));
     } else {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "cyclone/controller.hpp"
+#include "../models/current.hpp"
+#include "views/compiled_view.hpp"
 
 class ApplicationController : public Cyclone::Controller {
 protected:
@@ -14,18 +16,16 @@ protected:
         setViewVar("current_year", std::to_string(currentYear()));
 
         // Set current user if authenticated
-        if (auto user = currentUser()) {
+        if (const auto& user = currentUser()) {
             setViewVar("current_user", *user);
         }
     }
 
     // Helper methods for controllers
-    std::optional<User> currentUser() {
-        if (loggedIn()) {
-            auto userId = session().get<int>("user_id");
-            return User::find(userId);
-        }
-        return std::nullopt;
+
+    // Resolved once per request and shared with middleware and helpers
+    const std::optional<User>& currentUser() {
+        return Current::user(session());
     }
 
     bool loggedIn() const {
@@ -39,8 +39,21 @@ protected:
         }
     }
 
+    // Render a partial once per item into a single buffer. The partial is
+    // resolved once; compiled partials rebind only the item variable per row.
+    template <typename T>
+    std::string renderCollection(const std::string& partial, const std::vector<T>& items, const std::string& as) {
+        CompiledViews::OutputBuffer out;
+        if (!CompiledViews::renderCollection(partial, items, as, viewContext(), out)) {
+            for (const auto& item : items) {
+                out.append(renderPartial(partial, {{as, item}}));
+            }
+        }
+        return out.release();
+    }
+
     void requireAdmin() {
-        if (auto user = currentUser()) {
+        if (const auto& user = currentUser()) {
             if (!user->isAdmin()) {
                 flash().alert = "You are not authorized to access this page";
                 redirectTo("/");
@@ -4,9 +4,33 @@
 #include "../models/post.hpp"
 #include "../models/comment.hpp"
 #include "../jobs/notification_job.hpp"
+#include "text/mention_scanner.hpp"
+#include <algorithm>
 
 class CommentsController : public ApplicationController {
 public:
+  // GET /posts/:post_id/comments
+  // Returns one page of rendered comments for AJAX "load more"
+  Cyclone::Response index(int postId) {
+    constexpr int kMaxPerPage = 100;
+
+    auto page = std::max(request().params.get<int>("page", 1), 1);
+    auto perPage = std::clamp(request().params.get<int>("per_page", 50), 1, kMaxPerPage);
+
+    auto paginator = Comment::where("post_id", postId)
+      .orderBy("created_at", "ASC")
+      .paginate(page, perPage);
+
+    auto comments = paginator.items();
+    preload<User>(comments);
+
+    return jsonResponse({
+      {"page", page},
+      {"next_page", paginator.next_page},
+      {"html", renderCollection("comments/_comment", comments, "comment")}
+    });
+  }
+
   // POST /posts/:post_id/comments
   Cyclone::Response create(int postId) {
     requireLogin();
@@ -25,35 +49,18 @@ public:
     comment.setUserId(currentUser()->id());
     comment.setPostId(postId);
 
-    if (comment.save()) {
-      // Extract mentions from comment content
-      auto mentions = extractMentions(comment.content());
-
-      // Send notification to post author if they didn't write the comment
-      if (post->userId() != currentUser()->id()) {
-        JobQueue::enqueue<NotificationJob>({
-          .type = NotificationJob::Type::NewComment,
-          .user_id = post->userId(),
-          .source_user_id = currentUser()->id(),
-          .post_id = postId,
-          .comment_id = comment.id()
-        });
-      }
-
-      // Send notifications for mentions
-      for (const auto& mentionedUser : mentions) {
-        // Don't notify the comment author or post author (they already get a notification)
-        if (mentionedUser.id() != currentUser()->id() && mentionedUser.id() != post->userId()) {
-          JobQueue::enqueue<NotificationJob>({
-            .type = NotificationJob::Type::MentionedInComment,
-            .user_id = mentionedUser.id(),
-            .source_user_id = currentUser()->id(),
-            .post_id = postId,
-            .comment_id = comment.id()
-          });
-        }
+    // The comment and its notification jobs commit together; see
+    // lib/jobs/outbox.hpp
+    bool saved = false;
+    Cyclone::Database::transaction([&]() {
+      saved = comment.save();
+      if (saved) {
+        // All of them in one batch, however many users were mentioned
+        NotificationJob::notifyAll(notificationsFor(*post, comment));
       }
+    });
 
+    if (saved) {
       flash().notice = "Comment was successfully created";
 
       // Check if this is an AJAX request
@@ -109,29 +116,32 @@ public:
     // Get the old content for mention comparison
     auto oldContent = comment->content();
 
-    if (comment->update(params)) {
-      // Find new mentions that weren't in the original comment
-      auto oldMentions = extractMentions(oldContent);
-      auto newMentions = extractMentions(comment->content());
+    bool updated = false;
+    Cyclone::Database::transaction([&]() {
+      updated = comment->update(params);
+      if (updated) {
+        // Find new mentions that weren't in the original comment
+        auto newMentions = extractMentions(comment->content(), oldContent);
 
-      // Send notifications for new mentions
-      for (const auto& mentionedUser : newMentions) {
-        // Check if this user wasn't mentioned before
-        if (std::find_if(oldMentions.begin(), oldMentions.end(),
-            [&mentionedUser](const User& u) { return u.id() == mentionedUser.id(); }) == oldMentions.end()) {
+        // Send notifications for new mentions, in one batch
+        std::vector<NotificationJob::Params> notifications;
+        for (int mentionedId : newMentions) {
           // Don't notify the comment author
-          if (mentionedUser.id() != currentUser()->id()) {
-            JobQueue::enqueue<NotificationJob>({
+          if (mentionedId != currentUser()->id()) {
+            notifications.push_back({
               .type = NotificationJob::Type::MentionedInComment,
-              .user_id = mentionedUser.id(),
+              .user_id = mentionedId,
               .source_user_id = currentUser()->id(),
               .post_id = postId,
               .comment_id = id
             });
           }
         }
+        NotificationJob::notifyAll(notifications);
       }
+    });
 
+    if (updated) {
       flash().notice = "Comment was successfully updated";
 
       if (request().isAjax()) {
@@ -208,34 +218,63 @@ private:
     return response;
   }
 
-  // Extract mentions from comment content (usernames starting with @)
-  std::vector<User> extractMentions(const std::string& content) {
-    std::vector<User> mentions;
-    std::regex mentionRegex("@([a-zA-Z0-9_]+)");
+  // Notifications for a new comment: the post author and everyone mentioned
+  std::vector<NotificationJob::Params> notificationsFor(const Post& post, const Comment& comment) {
+    // Extract mentions from comment content
+    auto mentions = extractMentions(comment.content());
+
+    std::vector<NotificationJob::Params> notifications;
+
+    // Send notification to post author if they didn't write the comment
+    if (post.userId() != currentUser()->id()) {
+      notifications.push_back({
+        .type = NotificationJob::Type::NewComment,
+        .user_id = post.userId(),
+        .source_user_id = currentUser()->id(),
+        .post_id = post.id(),
+        .comment_id = comment.id()
+      });
+    }
 
-    std::sregex_iterator it(content.begin(), content.end(), mentionRegex);
-    std::sregex_iterator end;
+    // Send notifications for mentions
+    for (int mentionedId : mentions) {
+      // Don't notify the comment author or post author (they already get a notification)
+      if (mentionedId != currentUser()->id() && mentionedId != post.userId()) {
+        notifications.push_back({
+          .type = NotificationJob::Type::MentionedInComment,
+          .user_id = mentionedId,
+          .source_user_id = currentUser()->id(),
+          .post_id = post.id(),
+          .comment_id = comment.id()
+        });
+      }
+    }
 
-    std::unordered_set<std::string> processedUsernames;
+    return notifications;
+  }
 
-    while (it != end) {
-      std::string username = it->str(1);
+  // Ids of the users mentioned in `content` (usernames starting with @),
+  // skipping names already mentioned in `previousContent`; one query at most
+  std::vector<int> extractMentions(const std::string& content, const std::string& previousContent = "") {
+    auto names = Mentions::scan(content);
 
-      // Skip if we've already processed this username
-      if (processedUsernames.find(username) != processedUsernames.end()) {
-        ++it;
-        continue;
-      }
+    if (!previousContent.empty()) {
+      auto previous = Mentions::scan(previousContent);
+      std::erase_if(names, [&](std::string_view name) {
+        return std::find(previous.begin(), previous.end(), name) != previous.end();
+      });
+    }
 
-      processedUsernames.insert(username);
+    std::vector<int> mentions;
+    if (names.empty()) {
+      return mentions;
+    }
 
-      // Find user by username
-      auto user = User::findBy("name", username);
-      if (user) {
-        mentions.push_back(*user);
+    auto ids = User::idsByName(names, /* cached */ true);
+    for (auto name : names) {
+      if (auto it = ids.find(std::string(name)); it != ids.end()) {
+        mentions.push_back(it->second);
       }
-
-      ++it;
     }
 
     return mentions;
@@ -19,24 +19,12 @@ public:
       return jsonResponse({{"error", "Post not found"}}, 404);
     }
 
-    // Check if user already liked this post
-    auto existingLike = Like::forPost(id).byUser(currentUser()->id()).first();
-
-    if (existingLike) {
-      return jsonResponse({{"error", "You have already liked this post"}}, 422);
-    }
-
-    // Create the like
-    auto like = Like::new_({
-      {"user_id", currentUser()->id()},
-      {"likeable_id", id},
-      {"likeable_type", "Post"}
-    });
-
-    if (like.save()) {
+    // Insert unless the user already liked this post; the unique index
+    // decides, so there is no lookup first
+    if (Like::likeOnce(currentUser()->id(), id, "Post")) {
       // Enqueue notification job if the like is not from the post author
       if (post->userId() != currentUser()->id()) {
-        JobQueue::enqueue<NotificationJob>({
+        NotificationJob::notify({
           .type = NotificationJob::Type::NewLike,
           .user_id = post->userId(),
           .source_user_id = currentUser()->id(),
@@ -44,13 +32,12 @@ public:
         });
       }
 
-      // Return updated like count
       return jsonResponse({
-        {"like_count", post->likeCount()},
+        {"like_count", likeCountAfterChange(*post, "Post")},
         {"message", "Post liked successfully"}
       });
     } else {
-      return jsonResponse({{"error", "Failed to like post"}}, 422);
+      return jsonResponse({{"error", "You have already liked this post"}}, 422);
     }
   }
 
@@ -65,19 +52,13 @@ public:
       return jsonResponse({{"error", "Post not found"}}, 404);
     }
 
-    // Find the like
-    auto like = Like::forPost(id).byUser(currentUser()->id()).first();
-
-    if (!like) {
+    // Remove the like, if there is one
+    if (!Like::unlikeOnce(currentUser()->id(), id, "Post")) {
       return jsonResponse({{"error", "You have not liked this post"}}, 422);
     }
 
-    // Remove the like
-    like->destroy();
-
-    // Return updated like count
     return jsonResponse({
-      {"like_count", post->likeCount()},
+      {"like_count", likeCountAfterChange(*post, "Post")},
       {"message", "Post unliked successfully"}
     });
   }
@@ -93,24 +74,12 @@ public:
       return jsonResponse({{"error", "Comment not found"}}, 404);
     }
 
-    // Check if user already liked this comment
-    auto existingLike = Like::forComment(id).byUser(currentUser()->id()).first();
-
-    if (existingLike) {
-      return jsonResponse({{"error", "You have already liked this comment"}}, 422);
-    }
-
-    // Create the like
-    auto like = Like::new_({
-      {"user_id", currentUser()->id()},
-      {"likeable_id", id},
-      {"likeable_type", "Comment"}
-    });
-
-    if (like.save()) {
+    // Insert unless the user already liked this comment; the unique index
+    // decides, so there is no lookup first
+    if (Like::likeOnce(currentUser()->id(), id, "Comment")) {
       // Enqueue notification job if the like is not from the comment author
       if (comment->userId() != currentUser()->id()) {
-        JobQueue::enqueue<NotificationJob>({
+        NotificationJob::notify({
           .type = NotificationJob::Type::NewLike,
           .user_id = comment->userId(),
           .source_user_id = currentUser()->id(),
@@ -118,13 +87,12 @@ public:
         });
       }
 
-      // Return updated like count
       return jsonResponse({
-        {"like_count", comment->likeCount()},
+        {"like_count", likeCountAfterChange(*comment, "Comment")},
         {"message", "Comment liked successfully"}
       });
     } else {
-      return jsonResponse({{"error", "Failed to like comment"}}, 422);
+      return jsonResponse({{"error", "You have already liked this comment"}}, 422);
     }
   }
 
@@ -139,24 +107,29 @@ public:
       return jsonResponse({{"error", "Comment not found"}}, 404);
     }
 
-    // Find the like
-    auto like = Like::forComment(id).byUser(currentUser()->id()).first();
-
-    if (!like) {
+    // Remove the like, if there is one
+    if (!Like::unlikeOnce(currentUser()->id(), id, "Comment")) {
       return jsonResponse({{"error", "You have not liked this comment"}}, 422);
     }
 
-    // Remove the like
-    like->destroy();
-
-    // Return updated like count
     return jsonResponse({
-      {"like_count", comment->likeCount()},
+      {"like_count", likeCountAfterChange(*comment, "Comment")},
       {"message", "Comment unliked successfully"}
     });
   }
 
 private:
+  // With write-behind counters the stored column plus the unflushed delta;
+  // otherwise the column, re-read now that the Like callback updated it
+  template <typename Likeable>
+  int likeCountAfterChange(Likeable& likeable, const std::string& likeableType) {
+    if (CounterCache::deferred()) {
+      return Like::displayedCount(likeableType, likeable.id(), likeable.likeCount());
+    }
+    likeable.reload();
+    return likeable.likeCount();
+  }
+
   Cyclone::Response jsonResponse(const Cyclone::Json& data, int status = 200) {
     auto response = Cyclone::Response::json(data, status);
 
@@ -8,10 +8,11 @@ public:
     // GET /
     Cyclone::Response home() {
         // Fetch recent posts for the homepage
-        auto posts = Post::published()
-          .orderBy("created_at", "DESC")
-          .limit(5)
-          .get();
+        auto posts = includes<User>(
+          Post::published()
+            .orderBy("created_at", "DESC")
+            .limit(5)
+        );
 
         return render("pages/home", {
           {"posts", posts},
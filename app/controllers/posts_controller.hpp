@@ -2,13 +2,22 @@
 
 #include "application_controller.hpp"
 #include "../models/post.hpp"
+#include "../models/comment.hpp"
+#include "database/seek_pagination.hpp"
 
 class PostsController : public ApplicationController {
 public:
   // GET /posts
   Cyclone::Response index() {
-    auto posts = Post::published().orderBy("created_at", "DESC").get();
-    return render("posts/index", {{"posts", posts}});
+    auto cursor = request().params.get<std::string>("cursor", "");
+
+    auto page = seekPaginate(Post::published(), cursor, 20);
+    preload<User>(page.items);
+
+    return render("posts/index", {
+      {"posts", page.items},
+      {"pagination", page.pagination}
+    });
   }
 
   // GET /posts/:id
@@ -19,9 +28,9 @@ public:
       return resourceNotFound("Post not found");
     }
 
-    auto comments = post->comments()
-      .orderBy("created_at", "ASC")
-      .get();
+    auto comments = includes<User>(
+      post->comments().orderBy("created_at", "ASC")
+    );
 
     return render("posts/show", {
       {"post", *post},
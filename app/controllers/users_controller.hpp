@@ -3,6 +3,7 @@
 #include "application_controller.hpp"
 #include "../models/user.hpp"
 #include "../models/post.hpp"
+#include "../models/comment.hpp"
 
 class UsersController : public ApplicationController {
 public:
@@ -16,10 +17,11 @@ public:
       .get();
 
     // Get user's comments
-    auto comments = Comment::where("user_id", currentUser()->id())
-      .orderBy("created_at", "DESC")
-      .limit(10)
-      .get();
+    auto comments = includes<Post>(
+      Comment::where("user_id", currentUser()->id())
+        .orderBy("created_at", "DESC")
+        .limit(10)
+    );
 
     return render("users/profile", {
       {"user", *currentUser()},
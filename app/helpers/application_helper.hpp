@@ -4,6 +4,9 @@
 #include "../models/post.hpp"
 #include "../models/comment.hpp"
 #include "../models/like.hpp"
+#include "database/seek_pagination.hpp"
+#include "views/html_escape.hpp"
+#include "text/url_encode.hpp"
 
 class ApplicationHelper : public Cyclone::Helper {
 public:
@@ -52,9 +55,10 @@ public:
 
   // Convert markdown to HTML
   std::string markdown(const std::string& content) {
-    // This would use a markdown library to convert the content to HTML
-    // For simplicity, we'll just return the content as-is
-    return content;
+    // This would use a markdown library to convert the content to HTML.
+    // Until then the content is escaped, since callers treat the result as
+    // safe markup.
+    return Html::escape(content);
   }
 
   // Check if the current user has liked a post
@@ -75,8 +79,27 @@ public:
     return Like::forComment(comment.id()).byUser(currentUser()->id()).exists();
   }
 
+  // Render a partial once per item of a collection
+  template <typename T>
+  std::string renderCollection(const std::string& partial, const std::vector<T>& items, const std::string& as) {
+    return controller()->renderCollection(partial, items, as);
+  }
+
+  // Percent-encode a value for a query string built in a template
+  std::string urlEncode(const std::string& value) {
+    return Url::encode(value);
+  }
+
+  // Previous / next links for a seekPaginate() page; `path` ends in ? or &
+  std::string seekPaginationLinks(const SeekPagination& pagination, const std::string& path) {
+    return controller()->renderPartial("shared/_seek_pagination", {
+      {"pagination", pagination},
+      {"path", path}
+    });
+  }
+
   // Get the current user from the controller
-  std::optional<User> currentUser() {
+  const std::optional<User>& currentUser() {
     return controller()->currentUser();
   }
 
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "database/projection.hpp"
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Pending notifications coalesced per (recipient, type) window
+ *
+ * Instead of one job and one email per like, comment or mention, each event
+ * is stored as a pending_notifications row. The first event for a recipient
+ * and type also opens a notification_windows row. Opening a window is what
+ * schedules the single digest job, `window()` later. That job closes the
+ * window and drains every pending row for the key in one go:
+ *
+ *   Cyclone::Database::transaction([&]() {
+ *     if (NotificationDigest::add(userId, type, sourceUserId, postId, commentId)) {
+ *       // Goes through the outbox, so it commits with the window
+ *       Jobs::enqueueMany<NotificationJob>(digests, NotificationDigest::window());
+ *     }
+ *   });
+ *   auto opened = NotificationDigest::addAll(events);   // two statements for any number
+ *   ...
+ *   auto events = NotificationDigest::take(userId, type);   // in the job
+ *
+ * The window is opened with an INSERT ... ON CONFLICT DO UPDATE on a unique
+ * (user_id, type) index that bumps the window's `adds`, so exactly one
+ * request per window sees it opened (adds = 1), across every server
+ * process. Events are inserted before the window is opened or bumped, and
+ * the bump locks an open window until the request commits, so take(), which
+ * deletes the window before reading events, waits for it and then sees its
+ * events. So an event is either drained by the job that is running or opens
+ * the next window.
+ *
+ * Open windows in the transaction that enqueues their digest jobs, as
+ * NotificationJob::notifyAll does, so the two commit together. A window
+ * whose job still never runs (the job store lost it, or a caller opened it
+ * outside a transaction) would block its key for good. The sweeper
+ * (startSweeper) looks for windows still open `grace` after their flush_at,
+ * pushes flush_at back and schedules their digest again, in one transaction:
+ *
+ *   NotificationDigest::startSweeper({.grace = 5min}, &NotificationJob::resumeDigests);
+ */
+
+struct PendingNotification {
+  int id = 0;
+  int sourceUserId = 0;
+  int postId = 0;
+  int commentId = 0;
+
+  static constexpr auto fields() {
+    return std::tuple{
+      Projection::field("id", &PendingNotification::id),
+      Projection::field("source_user_id", &PendingNotification::sourceUserId),
+      Projection::field("post_id", &PendingNotification::postId),
+      Projection::field("comment_id", &PendingNotification::commentId)
+    };
+  }
+};
+
+class NotificationDigest {
+public:
+  // Coalescing window; zero turns coalescing off
+  static void configure(std::chrono::seconds window) {
+    windowSetting() = window;
+  }
+
+  static std::chrono::seconds window() {
+    return windowSetting();
+  }
+
+  static bool enabled() {
+    return windowSetting().count() > 0;
+  }
+
+  struct Event {
+    int userId;
+    int type;
+    int sourceUserId;
+    int postId = 0;
+    int commentId = 0;
+  };
+
+  // Record an event; true when it opened a new window, and the caller must
+  // schedule the digest job
+  static bool add(int userId, int type, int sourceUserId, int postId, int commentId) {
+    Event event{userId, type, sourceUserId, postId, commentId};
+    return !addAll({&event, 1}).empty();
+  }
+
+  // Record several events with one INSERT for the events and one for the
+  // windows; returns the (user_id, type) windows they opened
+  static std::vector<std::pair<int, int>> addAll(std::span<const Event> events) {
+    std::vector<std::pair<int, int>> opened;
+    if (events.empty()) {
+      return opened;
+    }
+
+    auto now = TimePoint::now();
+    std::vector<std::pair<int, int>> keys;
+    for (size_t start = 0; start < events.size(); start += kRowsPerStatement) {
+      auto chunk = events.subspan(start, std::min(kRowsPerStatement, events.size() - start));
+
+      std::string sql = "INSERT INTO pending_notifications "
+                        "(user_id, type, source_user_id, post_id, comment_id, created_at) VALUES ";
+      std::vector<std::any> bindings;
+      for (const auto& event : chunk) {
+        sql += bindings.empty() ? "(?, ?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?, ?)";
+        bindings.insert(bindings.end(), {event.userId, event.type, event.sourceUserId,
+                                         event.postId, event.commentId, now});
+        keys.emplace_back(event.userId, event.type);
+      }
+      Cyclone::Database::execute(sql, bindings);
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    for (size_t start = 0; start < keys.size(); start += kRowsPerStatement) {
+      auto end = std::min(keys.size(), start + kRowsPerStatement);
+
+      std::string sql = "INSERT INTO notification_windows (user_id, type, flush_at) VALUES ";
+      std::vector<std::any> bindings;
+      for (size_t i = start; i < end; i++) {
+        sql += bindings.empty() ? "(?, ?, ?)" : ", (?, ?, ?)";
+        bindings.insert(bindings.end(), {keys[i].first, keys[i].second, now + window()});
+      }
+      // Touching an open window holds its row lock until this transaction
+      // commits, so a concurrent take() cannot drain the key without these events
+      sql += " ON CONFLICT (user_id, type) DO UPDATE SET adds = notification_windows.adds + 1"
+             " RETURNING user_id, type, adds";
+
+      Cyclone::Database::eachRow(sql, bindings, [&](const Cyclone::Database::RowView& row) {
+        if (row.get<int>(2) == 1) {
+          opened.emplace_back(row.get<int>(0), row.get<int>(1));
+        }
+      });
+    }
+    return opened;
+  }
+
+  // Close the window and remove its events, oldest first. Commit this before
+  // sending the digest: until then it holds the window's row lock, which
+  // every request adding to the key waits on.
+  static std::vector<PendingNotification> take(int userId, int type) {
+    Cyclone::Database::execute(
+      "DELETE FROM notification_windows WHERE user_id = ? AND type = ?",
+      {userId, type}
+    );
+
+    // One statement, so an event committed meanwhile is either taken here
+    // or left for the next window, never deleted unread
+    std::vector<PendingNotification> events;
+    Cyclone::Database::eachRow(
+      "DELETE FROM pending_notifications WHERE user_id = ? AND type = ? "
+      "RETURNING id, source_user_id, post_id, comment_id",
+      {userId, type},
+      [&](const Cyclone::Database::RowView& row) {
+        Projection::detail::decodeInto(row, events.emplace_back());
+      }
+    );
+
+    std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) { return a.id < b.id; });
+    return events;
+  }
+
+  // Windows still open `grace` after their flush_at. Each has its flush_at
+  // pushed back by one window, so the next sweep does not report it again
+  // before its rescheduled job has had a chance to run.
+  static std::vector<std::pair<int, int>> overdue(std::chrono::seconds grace) {
+    auto now = TimePoint::now();
+    std::vector<std::pair<int, int>> windows;
+    Cyclone::Database::eachRow(
+      "UPDATE notification_windows SET flush_at = ? WHERE flush_at < ? RETURNING user_id, type",
+      {now + window(), now - grace},
+      [&](const Cyclone::Database::RowView& row) {
+        windows.emplace_back(row.get<int>(0), row.get<int>(1));
+      }
+    );
+    return windows;
+  }
+
+  // Schedules the digest jobs of the windows it is given
+  using Reschedule = void (*)(std::span<const std::pair<int, int>> windows);
+
+  // Reschedule every overdue window; the jobs commit with the flush_at update
+  static size_t sweep(std::chrono::seconds grace, Reschedule reschedule) {
+    size_t swept = 0;
+    Cyclone::Database::transaction([&]() {
+      auto windows = overdue(grace);
+      if (!windows.empty()) {
+        reschedule(windows);
+      }
+      swept = windows.size();
+    });
+    return swept;
+  }
+
+  struct SweepOptions {
+    std::chrono::seconds interval{60};
+    std::chrono::seconds grace{300};
+  };
+
+  // Run sweep() in a background thread until stopSweeper()
+  static void startSweeper(SweepOptions options, Reschedule reschedule) {
+    auto& slot = sweeper();
+    if (!slot) {
+      slot = std::make_unique<Sweeper>(options, reschedule);
+    }
+  }
+
+  static void stopSweeper() {
+    sweeper().reset();
+  }
+
+private:
+  class Sweeper {
+  public:
+    Sweeper(SweepOptions options, Reschedule reschedule) : options_(options), reschedule_(reschedule) {
+      thread_ = std::thread([this] { run(); });
+    }
+
+    ~Sweeper() {
+      {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+      }
+      wake_.notify_all();
+      thread_.join();
+    }
+
+  private:
+    void run() {
+      std::unique_lock lock(mutex_);
+      while (!stopping_) {
+        wake_.wait_for(lock, options_.interval, [this] { return stopping_; });
+        if (stopping_) {
+          break;
+        }
+
+        lock.unlock();
+        try {
+          if (auto swept = sweep(options_.grace, reschedule_)) {
+            Logger::info("NotificationDigest: rescheduled {} overdue windows", swept);
+          }
+        } catch (const std::exception& e) {
+          Logger::error("NotificationDigest: sweep failed, retrying: {}", e.what());
+        }
+        lock.lock();
+      }
+    }
+
+    SweepOptions options_;
+    Reschedule reschedule_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+  };
+
+  static std::unique_ptr<Sweeper>& sweeper() {
+    static std::unique_ptr<Sweeper> slot;
+    return slot;
+  }
+
+  // Six bindings per event keeps a statement far below every driver's limit
+  static constexpr size_t kRowsPerStatement = 500;
+
+  static std::chrono::seconds& windowSetting() {
+    static std::chrono::seconds window{300};
+    return window;
+  }
+};
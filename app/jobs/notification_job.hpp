@@ -4,9 +4,20 @@
 #include "../models/user.hpp"
 #include "../models/post.hpp"
 #include "../models/comment.hpp"
+#include "notification_digest.hpp"
+#include "jobs/enqueue_many.hpp"
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class NotificationJob : public ApplicationJob {
 public:
+  // Stable name in job_outbox (see lib/jobs/outbox.hpp)
+  static constexpr const char* kOutboxName = "notification";
+
   // Notification types
   enum class Type {
     NewComment,
@@ -22,23 +33,76 @@ public:
     int source_user_id;  // User who triggered the notification
     int post_id = 0;     // Optional post ID
     int comment_id = 0;  // Optional comment ID
+    bool digest = false; // Send everything pending for (user_id, type) instead
 
     // Serialization methods required by the job system
     template <typename Archive>
     void serialize(Archive& ar) {
-      ar & static_cast<int>(type);
+      auto typeValue = static_cast<int>(type);
+      ar & typeValue;
+      type = static_cast<Type>(typeValue);
       ar & user_id;
       ar & source_user_id;
       ar & post_id;
       ar & comment_id;
+      ar & digest;
+    }
+
+    // Typical payload for bin/cy pulse:bench-serialize
+    static Params sample() {
+      return {Type::MentionedInComment, 48213, 90511, 120977, 3380412};
     }
   };
 
+  // Notify `params.user_id`. Comments, likes and mentions are coalesced per
+  // recipient and type for NotificationDigest::window(), then sent as one
+  // digest; published posts go out straight away.
+  static void notify(const Params& params) {
+    notifyAll({&params, 1});
+  }
+
+  // notify() for a list, e.g. every mention in a comment: two inserts for the
+  // coalesced events and one job queue round trip, however long the list.
+  // The windows and their digest jobs commit in one transaction (the jobs go
+  // through the outbox), so a failed enqueue cannot leave a window open
+  // with no job to close it.
+  static void notifyAll(std::span<const Params> params) {
+    std::vector<Params> immediate;
+    std::vector<NotificationDigest::Event> events;
+    for (const auto& item : params) {
+      if (!NotificationDigest::enabled() || item.type == Type::PostPublished) {
+        immediate.push_back(item);
+      } else {
+        events.push_back({item.user_id, static_cast<int>(item.type), item.source_user_id,
+                          item.post_id, item.comment_id});
+      }
+    }
+
+    if (!events.empty()) {
+      Cyclone::Database::transaction([&]() {
+        auto digests = digestsFor(NotificationDigest::addAll(events));
+        Jobs::enqueueMany<NotificationJob>(digests, NotificationDigest::window());
+      });
+    }
+    Jobs::enqueueMany<NotificationJob>(immediate);
+  }
+
+  // Digest jobs for windows whose own job was lost; the sweeper's
+  // NotificationDigest::Reschedule, called inside its transaction
+  static void resumeDigests(std::span<const std::pair<int, int>> windows) {
+    Jobs::enqueueMany<NotificationJob>(digestsFor(windows));
+  }
+
   // Constructor accepts parameters
   explicit NotificationJob(const Params& params) : params_(params) {}
 
   // Define job behavior
   void perform() override {
+    if (params_.digest) {
+      performDigest();
+      return;
+    }
+
     // Load user from database
     auto user = User::find(params_.user_id);
     if (!user) {
@@ -69,15 +133,7 @@ public:
     }
 
     // Record metrics
-    std::string typeStr;
-    switch (params_.type) {
-      case Type::NewComment: typeStr = "new_comment"; break;
-      case Type::NewLike: typeStr = "new_like"; break;
-      case Type::MentionedInComment: typeStr = "mentioned"; break;
-      case Type::PostPublished: typeStr = "post_published"; break;
-    }
-
-    Metrics::increment("notifications." + typeStr + ".sent");
+    Metrics::increment("notifications." + typeName() + ".sent");
   }
 
   // Job system interface methods
@@ -87,6 +143,250 @@ public:
 private:
   Params params_;
 
+  // Drain the recipient's window: a lone event gets the regular email,
+  // several get one digest
+  void performDigest() {
+    // Committed before anything is mailed: the window's row lock would
+    // otherwise hold every request notifying this key until SMTP answers
+    std::vector<PendingNotification> events;
+    Cyclone::Database::transaction([&]() {
+      events = NotificationDigest::take(params_.user_id, static_cast<int>(params_.type));
+    });
+    if (events.empty()) {
+      return;
+    }
+
+    try {
+      if (events.size() == 1) {
+        params_.digest = false;
+        params_.source_user_id = events[0].sourceUserId;
+        params_.post_id = events[0].postId;
+        params_.comment_id = events[0].commentId;
+        perform();
+        return;
+      }
+
+      sendDigest(events);
+    } catch (...) {
+      restore(events);
+      throw;
+    }
+  }
+
+  // A failed send puts its events back into a window of their own, with a
+  // digest job scheduled for it, instead of losing them
+  void restore(const std::vector<PendingNotification>& events) const {
+    std::vector<Params> params;
+    for (const auto& event : events) {
+      params.push_back({params_.type, params_.user_id, event.sourceUserId, event.postId, event.commentId});
+    }
+    notifyAll(params);
+  }
+
+  struct DigestItem {
+    std::string actor;
+    std::string line;
+    std::string url;
+  };
+
+  void sendDigest(const std::vector<PendingNotification>& events) {
+    auto user = User::find(params_.user_id);
+    if (!user) {
+      Logger::error("NotificationJob: User not found, id={}", params_.user_id);
+      return;
+    }
+
+    // Everything the events refer to, one IN query per table
+    std::vector<int> sourceIds;
+    std::vector<int> postIds;
+    std::vector<int> commentIds;
+    for (const auto& event : events) {
+      sourceIds.push_back(event.sourceUserId);
+      if (event.postId > 0) {
+        postIds.push_back(event.postId);
+      }
+      if (event.commentId > 0) {
+        commentIds.push_back(event.commentId);
+      }
+    }
+
+    std::unordered_map<int, std::string> names;
+    for (auto& source : select<UserOption>(User::where("users.id", "IN", distinct(sourceIds)))) {
+      names.emplace(source.id, std::move(source.name));
+    }
+
+    std::unordered_map<int, Comment> comments;
+    if (!commentIds.empty()) {
+      for (auto& comment : Comment::where("id", "IN", distinct(commentIds)).get()) {
+        postIds.push_back(comment.postId());
+        auto id = comment.id();
+        comments.emplace(id, std::move(comment));
+      }
+    }
+
+    std::unordered_map<int, Post> posts;
+    if (!postIds.empty()) {
+      for (auto& post : Post::where("id", "IN", distinct(postIds)).get()) {
+        auto id = post.id();
+        posts.emplace(id, std::move(post));
+      }
+    }
+
+    // Newest first; events whose user, post or comment is gone are dropped
+    std::vector<DigestItem> items;
+    for (auto event = events.rbegin(); event != events.rend(); ++event) {
+      if (auto item = describe(*event, names, posts, comments)) {
+        items.push_back(std::move(*item));
+      }
+    }
+    if (items.empty()) {
+      return;
+    }
+
+    std::string subject;
+    std::string templateName;
+    auto count = std::to_string(items.size());
+    switch (params_.type) {
+      case Type::NewComment:
+        subject = count + " new comments on your posts";
+        templateName = "comment_digest_notification";
+        break;
+      case Type::NewLike:
+        subject = count + " new likes on your content";
+        templateName = "like_digest_notification";
+        break;
+      case Type::MentionedInComment:
+        subject = "You were mentioned in " + count + " comments";
+        templateName = "mention_digest_notification";
+        break;
+      case Type::PostPublished:
+        return;
+    }
+
+    auto mailer = ServiceContainer::resolve<MailerService>();
+    mailer->sendTemplate(
+      user->email(),
+      subject,
+      templateName,
+      {
+        {"user_name", user->name()},
+        {"count", count},
+        {"actors", actorSummary(items)},
+        {"items", itemList(items)},
+        {"url", items.front().url}
+      }
+    );
+
+    Metrics::increment("notifications." + typeName() + "_digest.sent");
+  }
+
+  std::optional<DigestItem> describe(const PendingNotification& event,
+                                     const std::unordered_map<int, std::string>& names,
+                                     const std::unordered_map<int, Post>& posts,
+                                     const std::unordered_map<int, Comment>& comments) const {
+    auto name = names.find(event.sourceUserId);
+    if (name == names.end()) {
+      return std::nullopt;
+    }
+
+    const Comment* comment = nullptr;
+    if (event.commentId > 0) {
+      auto found = comments.find(event.commentId);
+      if (found == comments.end()) {
+        return std::nullopt;
+      }
+      comment = &found->second;
+    }
+
+    auto post = posts.find(comment ? comment->postId() : event.postId);
+    if (post == posts.end()) {
+      return std::nullopt;
+    }
+
+    auto postUrl = "/posts/" + std::to_string(post->second.id());
+    auto title = "\"" + truncate(post->second.title(), 60) + "\"";
+
+    switch (params_.type) {
+      case Type::NewComment:
+        return DigestItem{name->second, name->second + " commented on " + title + ": " + truncate(comment->content(), 100),
+                          postUrl + "#comment-" + std::to_string(comment->id())};
+      case Type::NewLike:
+        if (comment) {
+          return DigestItem{name->second, name->second + " liked your comment \"" + truncate(comment->content(), 60) + "\"",
+                            postUrl + "#comment-" + std::to_string(comment->id())};
+        }
+        return DigestItem{name->second, name->second + " liked your post " + title, postUrl};
+      case Type::MentionedInComment:
+        return DigestItem{name->second, name->second + " mentioned you on " + title + ": " + truncate(comment->content(), 100),
+                          postUrl + "#comment-" + std::to_string(comment->id())};
+      case Type::PostPublished:
+        break;
+    }
+    return std::nullopt;
+  }
+
+  // "Alice, Bob and 3 others"
+  static std::string actorSummary(const std::vector<DigestItem>& items) {
+    std::vector<std::string> actors;
+    for (const auto& item : items) {
+      if (std::find(actors.begin(), actors.end(), item.actor) == actors.end()) {
+        actors.push_back(item.actor);
+      }
+    }
+
+    if (actors.size() == 1) {
+      return actors[0];
+    }
+    if (actors.size() == 2) {
+      return actors[0] + " and " + actors[1];
+    }
+    auto others = actors.size() - 2;
+    return actors[0] + ", " + actors[1] + " and " + std::to_string(others) + (others == 1 ? " other" : " others");
+  }
+
+  // One line per event, the newest ten
+  static std::string itemList(const std::vector<DigestItem>& items) {
+    constexpr size_t kMaxItems = 10;
+
+    std::string list;
+    for (size_t i = 0; i < items.size() && i < kMaxItems; i++) {
+      list += items[i].line + "\n";
+    }
+    if (items.size() > kMaxItems) {
+      list += "and " + std::to_string(items.size() - kMaxItems) + " more\n";
+    }
+    return list;
+  }
+
+  static std::vector<Params> digestsFor(std::span<const std::pair<int, int>> windows) {
+    std::vector<Params> digests;
+    for (auto [userId, type] : windows) {
+      digests.push_back({
+        .type = static_cast<Type>(type),
+        .user_id = userId,
+        .source_user_id = 0,
+        .digest = true
+      });
+    }
+    return digests;
+  }
+
+  static std::vector<int> distinct(std::vector<int> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+  }
+
+  std::string typeName() const {
+    switch (params_.type) {
+      case Type::NewComment: return "new_comment";
+      case Type::NewLike: return "new_like";
+      case Type::MentionedInComment: return "mentioned";
+      case Type::PostPublished: return "post_published";
+    }
+    return "";
+  }
+
   void sendNewCommentNotification(const User& user, const User& sourceUser) {
     if (params_.post_id == 0 || params_.comment_id == 0) {
       Logger::error("NotificationJob: Missing post_id or comment_id for NewComment notification");
@@ -1,11 +1,17 @@
 #pragma once
 
 #include "cyclone/middleware.hpp"
-#include "../models/user.hpp"
+#include "../models/current.hpp"
 
 class AdminAuthMiddleware : public Cyclone::Middleware {
 public:
     Cyclone::Response process(const Cyclone::Request& request, Cyclone::MiddlewareNext next) override {
+        return handle(request, next);
+    }
+
+    // Pipeline layer entry point (see lib/middleware/pipeline.hpp)
+    template <typename Next>
+    Cyclone::Response handle(const Cyclone::Request& request, Next&& next) {
         // Check if user is logged in
         if (!request.session.has("user_id")) {
             // User is not logged in, redirect to login page
@@ -15,8 +21,8 @@ public:
         }
 
         // Check if user is an admin
-        auto userId = request.session.get<int>("user_id");
-        auto user = User::find(userId);
+        // Shared with the controller's currentUser() for the rest of the request
+        const auto& user = Current::user(request.session);
 
         if (!user || !user->isAdmin()) {
             // User is not an admin, redirect to homepage
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "cyclone/middleware.hpp"
+#include "database/replica_routing.hpp"
+#include <charconv>
+#include <chrono>
+#include <string>
+
+// Opens the per-request replica routing scope. After a request that wrote,
+// a short-lived cookie keeps the client's next requests reading from the
+// primary until the replica has had time to catch up.
+class ReplicaRoutingMiddleware : public Cyclone::Middleware {
+public:
+    static constexpr const char* kCookie = "_cy_primary_until";
+
+    Cyclone::Response process(const Cyclone::Request& request, Cyclone::MiddlewareNext next) override {
+        return handle(request, next);
+    }
+
+    // Pipeline layer entry point (see lib/middleware/pipeline.hpp)
+    template <typename Next>
+    Cyclone::Response handle(const Cyclone::Request& request, Next&& next) {
+        if (!Replicas::installed()) {
+            return next(request);
+        }
+
+        Replicas::Scope scope(pinnedByCookie(request));
+        auto response = next(request);
+
+        if (scope.wrote()) {
+            auto stickiness = Replicas::detail::config().options.stickiness;
+            response.setCookie(kCookie, std::to_string(epochMillis() + stickiness.count()), {
+              .maxAge = std::chrono::duration_cast<std::chrono::seconds>(stickiness).count() + 1,
+              .path = "/",
+              .httpOnly = true
+            });
+        }
+
+        return response;
+    }
+
+private:
+    // The cookie is unsigned: forging it only sends the client's own reads to the primary
+    static bool pinnedByCookie(const Cyclone::Request& request) {
+        auto cookie = request.cookie(kCookie);
+        if (!cookie) {
+            return false;
+        }
+
+        int64_t until = 0;
+        std::from_chars(cookie->data(), cookie->data() + cookie->size(), until);
+        return epochMillis() < until;
+    }
+
+    static int64_t epochMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
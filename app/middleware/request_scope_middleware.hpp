@@ -0,0 +1,23 @@
+#pragma once
+
+#include "cyclone/middleware.hpp"
+#include "../models/current.hpp"
+#include "../models/concerns/identity_map.hpp"
+
+// Opens the per-request identity map and Current attributes. Registered
+// first so that every later middleware, controller and view shares them.
+class RequestScopeMiddleware : public Cyclone::Middleware {
+public:
+    Cyclone::Response process(const Cyclone::Request& request, Cyclone::MiddlewareNext next) override {
+        return handle(request, next);
+    }
+
+    // Pipeline layer entry point (see lib/middleware/pipeline.hpp)
+    template <typename Next>
+    Cyclone::Response handle(const Cyclone::Request& request, Next&& next) {
+        IdentityMap::Scope identityMap;
+        Current::Scope current;
+
+        return next(request);
+    }
+};
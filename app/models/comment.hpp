@@ -3,21 +3,43 @@
 #include "cyclone/model.hpp"
 #include "user.hpp"
 #include "post.hpp"
+#include "concerns/preloadable.hpp"
+#include "concerns/counter_cache.hpp"
+#include "concerns/touching.hpp"
+#include "concerns/identity_map.hpp"
+#include "concerns/bulk_writable.hpp"
 
-class Comment : public Cyclone::Model<Comment> {
+class Like;
+
+class Comment : public Cyclone::Model<Comment>,
+                public Preloadable<Comment>,
+                public CounterCached<Comment>,
+                public Touching<Comment>,
+                public IdentityMapped<Comment>,
+                public BulkWritable<Comment> {
 public:
+    // Loaded at most once per request
+    using IdentityMapped<Comment>::find;
+
     static void defineSchema() {
         schema()
           .field<int>("id", {.primaryKey = true, .autoIncrement = true})
           .field<int>("user_id", {.nullable = false})
           .field<int>("post_id", {.nullable = false})
           .field<std::string>("content", {.nullable = false})
+          .field<int>("likes_count", {.default_ = 0})
           .timestamps();
 
         // Define relationships
         belongsTo<User>();
         belongsTo<Post>();
         hasMany<Like>();
+
+        // Keep posts.comments_count in sync
+        counterCache<Post>({.column = "comments_count", .foreignKey = "post_id"});
+
+        // Retire the post's cached fragments when its comments change
+        touches<Post>({.foreignKey = "post_id"});
     }
 
     // Validations
@@ -32,8 +54,63 @@ public:
         return orderBy("created_at", "DESC").limit(5);
     }
 
+    // Callbacks
+    void afterCreate() {
+        incrementCounterCaches();
+    }
+
+    void afterSave() {
+        touchParents();
+        rememberIdentity();
+    }
+
+    void afterDestroy() {
+        decrementCounterCaches();
+        touchParents();
+        forgetIdentity();
+    }
+
+    // Associations (served from the eager-loaded set when available)
+    // User::placeholder() when the author's row is gone
+    User user() const {
+        if (auto preloadedUser = preloaded<User>("user")) {
+            return preloadedUser->has_value() ? **preloadedUser : User::placeholder();
+        }
+        auto user = User::find(userId());
+        return user ? *user : User::placeholder();
+    }
+
+    // Post::placeholder() when the post's row is gone
+    Post post() const {
+        if (auto preloadedPost = preloaded<Post>("post")) {
+            return preloadedPost->has_value() ? **preloadedPost : Post::placeholder();
+        }
+        auto post = Post::find(postId());
+        return post ? *post : Post::placeholder();
+    }
+
     // Methods
     int likeCount() const {
-        return likes().count();
+        return likesCount();
     }
+};
+
+template <> struct AssociationTraits<Comment, User> {
+    static constexpr auto kind = AssociationKind::BelongsTo;
+    static constexpr const char* name = "user";
+    static constexpr const char* foreignKey = "user_id";
+};
+
+template <> struct AssociationTraits<Comment, Post> {
+    static constexpr auto kind = AssociationKind::BelongsTo;
+    static constexpr const char* name = "post";
+    static constexpr const char* foreignKey = "post_id";
+};
+
+template <> struct AssociationTraits<Comment, Like> {
+    static constexpr auto kind = AssociationKind::HasMany;
+    static constexpr const char* name = "likes";
+    static constexpr const char* foreignKey = "likeable_id";
+    static constexpr const char* typeColumn = "likeable_type";
+    static constexpr const char* polymorphicType = "Comment";
 };
\ No newline at end of file
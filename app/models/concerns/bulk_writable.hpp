@@ -0,0 +1,194 @@
+#pragma once
+
+#include "cyclone/model.hpp"
+#include "cyclone/database.hpp"
+#include <algorithm>
+#include <any>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Multi-row INSERT and upsert
+ *
+ *   Post::insertAll(rows);                                   // INSERT ... VALUES (...), (...), ...
+ *   Post::insertAll(rows, {.validate = false});              // seeding: no per-row validation
+ *   Like::insertAll(rows, {.skipDuplicates = true});         // ON CONFLICT DO NOTHING
+ *   User::upsertAll(rows, {"email"});                        // ON CONFLICT (email) DO UPDATE
+ *
+ * Rows are written `batchSize` at a time, one statement per batch, inside a
+ * single transaction. Consecutive rows with the same columns share a
+ * statement; a row with a different column set starts a new one.
+ *
+ * Unlike create(), no model callbacks run: counter caches, touches and the
+ * identity map are not maintained, and attributes are written as given
+ * (User passwords are not encrypted, for instance). Callers that depend on a
+ * callback run its effect themselves, as Like::likeOnce() does.
+ */
+
+struct BulkWriteOptions {
+  size_t batchSize = 1000;
+  bool validate = true;                     // Build each row and drop it when invalid
+  bool timestamps = true;                   // Fill created_at / updated_at when absent
+  bool skipDuplicates = false;              // insertAll: ON CONFLICT DO NOTHING
+  std::vector<std::string> updateColumns;   // upsertAll: defaults to every non-key column
+};
+
+struct BulkWriteResult {
+  size_t written = 0;                       // Rows inserted or updated
+  std::vector<size_t> invalid;              // Input indices rejected by validation
+};
+
+template <typename T>
+class BulkWritable {
+public:
+  using Attributes = std::map<std::string, std::any>;
+
+  static BulkWriteResult insertAll(std::vector<Attributes> rows, BulkWriteOptions options = {}) {
+    return write(std::move(rows), {}, options);
+  }
+
+  // Rows that collide on `conflictColumns` (a unique index) are updated in place
+  static BulkWriteResult upsertAll(std::vector<Attributes> rows, std::vector<std::string> conflictColumns,
+                                   BulkWriteOptions options = {}) {
+    return write(std::move(rows), conflictColumns, options);
+  }
+
+private:
+  // Stay under the adapter's bound parameter limit
+  static size_t maxParameters() {
+    return Cyclone::Database::adapter() == Cyclone::Database::Adapter::PostgreSQL ? 65535 : 32766;
+  }
+
+  static BulkWriteResult write(std::vector<Attributes> rows, const std::vector<std::string>& conflictColumns,
+                               const BulkWriteOptions& options) {
+    BulkWriteResult result;
+
+    std::vector<Attributes> accepted;
+    accepted.reserve(rows.size());
+    auto now = TimePoint::now();
+
+    for (size_t i = 0; i < rows.size(); i++) {
+      auto& row = rows[i];
+      if (options.validate && !T::new_(row).isValid()) {
+        result.invalid.push_back(i);
+        continue;
+      }
+      if (options.timestamps) {
+        row.try_emplace("created_at", now);
+        row.try_emplace("updated_at", now);
+      }
+      accepted.push_back(std::move(row));
+    }
+
+    if (accepted.empty()) {
+      return result;
+    }
+
+    Cyclone::Database::transaction([&]() {
+      size_t begin = 0;
+      while (begin < accepted.size()) {
+        auto columns = columnsOf(accepted[begin]);
+        auto limit = std::max<size_t>(1, std::min(options.batchSize, maxParameters() / std::max<size_t>(columns.size(), 1)));
+
+        size_t end = begin + 1;
+        while (end < accepted.size() && end - begin < limit && sameColumns(accepted[end], columns)) {
+          end++;
+        }
+
+        result.written += writeBatch(accepted, begin, end, columns, conflictColumns, options);
+        begin = end;
+      }
+    });
+
+    return result;
+  }
+
+  static size_t writeBatch(const std::vector<Attributes>& rows, size_t begin, size_t end,
+                           const std::vector<std::string>& columns,
+                           const std::vector<std::string>& conflictColumns,
+                           const BulkWriteOptions& options) {
+    std::string sql = "INSERT INTO " + T::tableName() + " (" + join(columns) + ") VALUES ";
+
+    std::string placeholders = "(";
+    for (size_t c = 0; c < columns.size(); c++) {
+      placeholders += c == 0 ? "?" : ", ?";
+    }
+    placeholders += ")";
+
+    std::vector<std::any> parameters;
+    parameters.reserve((end - begin) * columns.size());
+    for (size_t r = begin; r < end; r++) {
+      sql += r == begin ? placeholders : ", " + placeholders;
+      for (const auto& [column, value] : rows[r]) {
+        parameters.push_back(value);
+      }
+    }
+
+    sql += conflictClause(columns, conflictColumns, options);
+    return Cyclone::Database::execute(sql, parameters);
+  }
+
+  static std::string conflictClause(const std::vector<std::string>& columns,
+                                    const std::vector<std::string>& conflictColumns,
+                                    const BulkWriteOptions& options) {
+    if (conflictColumns.empty()) {
+      return options.skipDuplicates ? " ON CONFLICT DO NOTHING" : "";
+    }
+
+    auto updates = options.updateColumns;
+    if (updates.empty()) {
+      for (const auto& column : columns) {
+        if (column != "id" && column != "created_at" &&
+            std::find(conflictColumns.begin(), conflictColumns.end(), column) == conflictColumns.end()) {
+          updates.push_back(column);
+        }
+      }
+    }
+
+    std::string clause = " ON CONFLICT (" + join(conflictColumns) + ")";
+    if (updates.empty()) {
+      return clause + " DO NOTHING";
+    }
+
+    clause += " DO UPDATE SET ";
+    for (size_t i = 0; i < updates.size(); i++) {
+      if (i > 0) {
+        clause += ", ";
+      }
+      clause += updates[i] + " = excluded." + updates[i];
+    }
+    return clause;
+  }
+
+  // Attributes is ordered, so equal key sets list columns in the same order
+  static std::vector<std::string> columnsOf(const Attributes& row) {
+    std::vector<std::string> columns;
+    columns.reserve(row.size());
+    for (const auto& [column, value] : row) {
+      columns.push_back(column);
+    }
+    return columns;
+  }
+
+  static bool sameColumns(const Attributes& row, const std::vector<std::string>& columns) {
+    if (row.size() != columns.size()) {
+      return false;
+    }
+    size_t i = 0;
+    for (const auto& [column, value] : row) {
+      if (column != columns[i++]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static std::string join(const std::vector<std::string>& columns) {
+    std::string joined;
+    for (size_t i = 0; i < columns.size(); i++) {
+      joined += i == 0 ? columns[i] : ", " + columns[i];
+    }
+    return joined;
+  }
+};
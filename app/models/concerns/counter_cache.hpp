@@ -0,0 +1,247 @@
+#pragma once
+
+#include "cyclone/model.hpp"
+#include "cyclone/database.hpp"
+#include "identity_map.hpp"
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Denormalized association counters
+ *
+ * A child model declares, next to its belongsTo relationship, which parent
+ * column counts it:
+ *
+ *   belongsTo<Post>();
+ *   counterCache<Post>({.column = "comments_count", .foreignKey = "post_id"});
+ *
+ * The parent column is adjusted with a single `col = col + ?` UPDATE from the
+ * child's afterCreate/afterDestroy callbacks, which run inside the save/destroy
+ * transaction, so the count and the row commit or roll back together.
+ * `bin/cy db:counters:rebuild` recomputes every registered column from scratch.
+ *
+ * Counters declared with `.writeBehind = true` are handed to the installed
+ * DeferredCounterWriter instead (see write_behind_counters.hpp), which keeps
+ * the delta in memory and brings the column up to date on its next flush.
+ * Requests reach the writer through a WriterLease, and uninstalling it waits
+ * for the leases still held, so a writer is never destroyed under a request.
+ */
+
+struct CounterCacheOptions {
+  std::string column;                   // Counter column on the parent table
+  std::string foreignKey;               // Column on the child pointing at the parent
+  std::string typeColumn = "";          // Polymorphic associations only
+  std::string polymorphicType = "";     // Value of typeColumn that selects this parent
+  bool writeBehind = false;             // Defer to the DeferredCounterWriter when one is installed
+};
+
+struct CounterCacheDefinition {
+  std::string childTable;
+  std::string parentTable;
+  CounterCacheOptions options;
+};
+
+// Receives write-behind counter deltas; `definition` indexes CounterCache::definitions()
+class DeferredCounterWriter {
+public:
+  virtual ~DeferredCounterWriter() = default;
+  virtual void add(size_t definition, int parentId, int delta) = 0;
+  virtual int64_t pending(size_t definition, int parentId) const = 0;
+};
+
+class CounterCache {
+public:
+  // Every counter declared by any model, used by db:counters:rebuild
+  static std::vector<CounterCacheDefinition>& definitions() {
+    static std::vector<CounterCacheDefinition> registry;
+    return registry;
+  }
+
+  static void define(CounterCacheDefinition definition) {
+    auto& registry = definitions();
+    for (const auto& existing : registry) {
+      if (existing.childTable == definition.childTable &&
+          existing.parentTable == definition.parentTable &&
+          existing.options.column == definition.options.column) {
+        return;
+      }
+    }
+    registry.push_back(std::move(definition));
+  }
+
+  // Atomically add `delta` to the counter of one parent row
+  static void adjust(const CounterCacheDefinition& definition, int parentId, int delta) {
+    Cyclone::Database::execute(
+      "UPDATE " + definition.parentTable +
+      " SET " + definition.options.column + " = " + definition.options.column + " + ?" +
+      " WHERE id = ?",
+      {delta, parentId}
+    );
+    IdentityMap::evict(definition.parentTable, parentId);
+  }
+
+  static std::atomic<DeferredCounterWriter*>& deferredWriter() {
+    static std::atomic<DeferredCounterWriter*> writer{nullptr};
+    return writer;
+  }
+
+  // Borrow of the installed writer for the length of one call
+  class WriterLease {
+  public:
+    WriterLease() {
+      leases().fetch_add(1);
+      writer_ = deferredWriter().load();
+    }
+    ~WriterLease() { leases().fetch_sub(1, std::memory_order_release); }
+
+    WriterLease(const WriterLease&) = delete;
+    WriterLease& operator=(const WriterLease&) = delete;
+
+    DeferredCounterWriter* get() const { return writer_; }
+
+  private:
+    DeferredCounterWriter* writer_;
+  };
+
+  static void installDeferredWriter(DeferredCounterWriter* writer) {
+    deferredWriter().store(writer);
+  }
+
+  // Stop handing out the writer, then wait until no request still holds it;
+  // the caller may destroy it afterwards
+  static void uninstallDeferredWriter() {
+    deferredWriter().store(nullptr);
+    while (leases().load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Whether write-behind counters are being deferred rather than written
+  static bool deferred() {
+    return deferredWriter().load(std::memory_order_acquire) != nullptr;
+  }
+
+  // Delta not yet written to parentTable.column for one parent row
+  static int64_t pending(const std::string& parentTable, const std::string& column, int parentId) {
+    WriterLease lease;
+    auto* writer = lease.get();
+    if (!writer) {
+      return 0;
+    }
+
+    const auto& registry = definitions();
+    for (size_t i = 0; i < registry.size(); i++) {
+      if (registry[i].parentTable == parentTable && registry[i].options.column == column) {
+        return writer->pending(i, parentId);
+      }
+    }
+    return 0;
+  }
+
+  // Recompute one counter column for the listed parent rows and bump their
+  // updated_at (the write-behind flush, which also stands in for touches)
+  static void rebuild(const CounterCacheDefinition& definition, const std::vector<int>& parentIds) {
+    if (parentIds.empty()) {
+      return;
+    }
+
+    const auto& options = definition.options;
+
+    std::string sql =
+      "UPDATE " + definition.parentTable +
+      " SET " + options.column + " = (SELECT COUNT(*) FROM " + definition.childTable +
+      " WHERE " + definition.childTable + "." + options.foreignKey + " = " + definition.parentTable + ".id";
+
+    std::vector<std::any> parameters;
+    if (!options.typeColumn.empty()) {
+      sql += " AND " + definition.childTable + "." + options.typeColumn + " = ?";
+      parameters.emplace_back(options.polymorphicType);
+    }
+
+    sql += "), updated_at = ? WHERE id IN (";
+    parameters.emplace_back(TimePoint::now());
+    for (size_t i = 0; i < parentIds.size(); i++) {
+      sql += i == 0 ? "?" : ", ?";
+      parameters.emplace_back(parentIds[i]);
+    }
+    sql += ")";
+
+    Cyclone::Database::execute(sql, parameters);
+  }
+
+  // Recompute one counter column for every parent row
+  static void rebuild(const CounterCacheDefinition& definition) {
+    const auto& options = definition.options;
+
+    std::string sql =
+      "UPDATE " + definition.parentTable +
+      " SET " + options.column + " = (SELECT COUNT(*) FROM " + definition.childTable +
+      " WHERE " + definition.childTable + "." + options.foreignKey + " = " + definition.parentTable + ".id";
+
+    if (!options.typeColumn.empty()) {
+      sql += " AND " + definition.childTable + "." + options.typeColumn + " = ?";
+      sql += ")";
+      Cyclone::Database::execute(sql, {options.polymorphicType});
+    } else {
+      sql += ")";
+      Cyclone::Database::execute(sql, {});
+    }
+  }
+
+  static void rebuildAll() {
+    for (const auto& definition : definitions()) {
+      rebuild(definition);
+    }
+  }
+
+private:
+  static std::atomic<size_t>& leases() {
+    static std::atomic<size_t> count{0};
+    return count;
+  }
+};
+
+// Mixin for child models that maintain counters on their parents
+template <typename Child>
+class CounterCached {
+protected:
+  template <typename Parent>
+  static void counterCache(CounterCacheOptions options) {
+    CounterCache::define({Child::tableName(), Parent::tableName(), std::move(options)});
+  }
+
+  // Call from the child's afterCreate() / afterDestroy() callbacks
+  void incrementCounterCaches() const { adjustCounterCaches(+1); }
+  void decrementCounterCaches() const { adjustCounterCaches(-1); }
+
+private:
+  void adjustCounterCaches(int delta) const {
+    const auto& child = static_cast<const Child&>(*this);
+
+    const auto& registry = CounterCache::definitions();
+    for (size_t i = 0; i < registry.size(); i++) {
+      const auto& definition = registry[i];
+      if (definition.childTable != Child::tableName()) {
+        continue;
+      }
+
+      const auto& options = definition.options;
+      if (!options.typeColumn.empty() &&
+          child.template get<std::string>(options.typeColumn) != options.polymorphicType) {
+        continue;
+      }
+
+      auto parentId = child.template get<int>(options.foreignKey);
+      CounterCache::WriterLease lease;
+      if (auto* writer = lease.get(); writer && options.writeBehind) {
+        writer->add(i, parentId, delta);
+      } else {
+        CounterCache::adjust(definition, parentId, delta);
+      }
+    }
+  }
+};
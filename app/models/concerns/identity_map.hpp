@@ -0,0 +1,112 @@
+#pragma once
+
+#include "cyclone/model.hpp"
+#include <any>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Per-request identity map
+ *
+ * While an IdentityMap::Scope is open (RequestScopeMiddleware opens one around
+ * every request), `find(id)` on an IdentityMapped model loads each row at most
+ * once and serves later lookups from memory:
+ *
+ *   class User : public Cyclone::Model<User>, public IdentityMapped<User> {
+ *   public:
+ *     using IdentityMapped<User>::find;
+ *     void afterSave() { rememberIdentity(); }
+ *     void afterDestroy() { forgetIdentity(); }
+ *   };
+ *
+ * Requests are served start to finish on one worker thread, so the map is
+ * thread-local and needs no locking. Outside a scope (jobs, tasks, tests)
+ * find() goes straight to the database. Raw UPDATEs that bypass the model
+ * (counter caches, touches) must call IdentityMap::evict() for the rows they
+ * change.
+ */
+
+class IdentityMap {
+  // table name -> id -> std::optional<Model>
+  using Entries = std::unordered_map<std::string, std::unordered_map<int, std::any>>;
+
+public:
+  class Scope {
+  public:
+    Scope() : previous_(current()) { current() = &map_; }
+    ~Scope() { current() = previous_; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    Entries map_;
+    Entries* previous_;
+  };
+
+  static bool active() {
+    return current() != nullptr;
+  }
+
+  // The mapped row, or `load(id)` remembered for the rest of the scope
+  template <typename T, typename Loader>
+  static std::optional<T> fetch(int id, Loader&& load) {
+    auto* entries = current();
+    if (!entries) {
+      return load(id);
+    }
+
+    auto& table = (*entries)[T::tableName()];
+    if (auto it = table.find(id); it != table.end()) {
+      return std::any_cast<const std::optional<T>&>(it->second);
+    }
+
+    auto loaded = load(id);
+    table.emplace(id, loaded);
+    return loaded;
+  }
+
+  template <typename T>
+  static void store(const T& model) {
+    if (auto* entries = current()) {
+      (*entries)[T::tableName()].insert_or_assign(model.id(), std::optional<T>(model));
+    }
+  }
+
+  static void evict(const std::string& table, int id) {
+    if (auto* entries = current()) {
+      if (auto it = entries->find(table); it != entries->end()) {
+        it->second.erase(id);
+      }
+    }
+  }
+
+private:
+  static Entries*& current() {
+    thread_local Entries* entries = nullptr;
+    return entries;
+  }
+};
+
+// Mixin giving a model an identity-mapped find(); see IdentityMap above
+template <typename T>
+class IdentityMapped {
+public:
+  static std::optional<T> find(int id) {
+    return IdentityMap::fetch<T>(id, [](int id) {
+      return Cyclone::Model<T>::find(id);
+    });
+  }
+
+protected:
+  // Call from afterSave() so later finds see the saved attributes
+  void rememberIdentity() const {
+    IdentityMap::store(static_cast<const T&>(*this));
+  }
+
+  // Call from afterDestroy()
+  void forgetIdentity() const {
+    IdentityMap::evict(T::tableName(), static_cast<const T&>(*this).id());
+  }
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "cyclone/model.hpp"
+#include <any>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Eager loading for model associations
+ *
+ * A model that mixes in Preloadable can carry associations that were loaded
+ * in bulk for a whole result set, so that `post.user()` or `post.commentCount()`
+ * inside a view loop reads from memory instead of issuing one query per row.
+ *
+ * Usage:
+ *   auto posts = includes<User, Comment, Like>(
+ *     Post::published().orderBy("created_at", "DESC")
+ *   );
+ *
+ * Each association costs exactly one `WHERE ... IN (...)` query, regardless of
+ * the number of rows returned by the base query.
+ */
+
+enum class AssociationKind {
+  BelongsTo,
+  HasMany
+};
+
+// Describes how Owner joins to Target. Specialised next to each model, e.g.
+//
+//   template <> struct AssociationTraits<Post, User> {
+//     static constexpr auto kind = AssociationKind::BelongsTo;
+//     static constexpr const char* name = "user";
+//     static constexpr const char* foreignKey = "user_id";
+//   };
+//
+// For polymorphic hasMany associations (likes), `polymorphicType` names the
+// owner type stored in the `<as>_type` column of the target table.
+template <typename Owner, typename Target>
+struct AssociationTraits;
+
+template <typename Owner>
+class Preloadable {
+public:
+  // Attach a preloaded belongsTo target (or std::nullopt when the row is missing)
+  template <typename Target>
+  void setPreloaded(const std::string& association, std::optional<Target> target) {
+    preloads_[association] = std::move(target);
+  }
+
+  // Attach the preloaded rows of a hasMany association
+  template <typename Target>
+  void setPreloadedMany(const std::string& association, std::vector<Target> targets) {
+    counts_[association] = targets.size();
+    preloads_[association] = std::move(targets);
+  }
+
+  // The preloaded belongsTo target, or nullptr if the association was not preloaded
+  template <typename Target>
+  const std::optional<Target>* preloaded(const std::string& association) const {
+    auto it = preloads_.find(association);
+    return it == preloads_.end() ? nullptr : std::any_cast<std::optional<Target>>(&it->second);
+  }
+
+  // The preloaded hasMany rows, or nullptr if the association was not preloaded
+  template <typename Target>
+  const std::vector<Target>* preloadedMany(const std::string& association) const {
+    auto it = preloads_.find(association);
+    return it == preloads_.end() ? nullptr : std::any_cast<std::vector<Target>>(&it->second);
+  }
+
+  // Number of preloaded hasMany rows; usable where Target is still incomplete
+  std::optional<size_t> preloadedCount(const std::string& association) const {
+    auto it = counts_.find(association);
+    if (it == counts_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  bool isPreloaded(const std::string& association) const {
+    return preloads_.contains(association);
+  }
+
+private:
+  std::unordered_map<std::string, std::any> preloads_;
+  std::unordered_map<std::string, size_t> counts_;
+};
+
+namespace Preloader {
+
+  template <typename Owner, typename Target>
+  void preloadBelongsTo(std::vector<Owner>& owners) {
+    using Traits = AssociationTraits<Owner, Target>;
+
+    std::unordered_set<int> seen;
+    std::vector<int> ids;
+    for (const auto& owner : owners) {
+      auto id = owner.template get<int>(Traits::foreignKey);
+      if (seen.insert(id).second) {
+        ids.push_back(id);
+      }
+    }
+
+    std::unordered_map<int, Target> byId;
+    if (!ids.empty()) {
+      for (auto& target : Target::where("id", "IN", ids).get()) {
+        auto id = target.id();
+        byId.emplace(id, std::move(target));
+      }
+    }
+
+    for (auto& owner : owners) {
+      auto it = byId.find(owner.template get<int>(Traits::foreignKey));
+      owner.template setPreloaded<Target>(
+        Traits::name,
+        it == byId.end() ? std::nullopt : std::optional<Target>(it->second)
+      );
+    }
+  }
+
+  template <typename Owner, typename Target>
+  void preloadHasMany(std::vector<Owner>& owners) {
+    using Traits = AssociationTraits<Owner, Target>;
+
+    std::vector<int> ids;
+    ids.reserve(owners.size());
+    for (const auto& owner : owners) {
+      ids.push_back(owner.id());
+    }
+
+    std::unordered_map<int, std::vector<Target>> byOwner;
+    if (!ids.empty()) {
+      auto query = Target::where(Traits::foreignKey, "IN", ids);
+      if constexpr (requires { Traits::polymorphicType; }) {
+        query = query.where(Traits::typeColumn, Traits::polymorphicType);
+      }
+
+      for (auto& target : query.get()) {
+        auto ownerId = target.template get<int>(Traits::foreignKey);
+        byOwner[ownerId].push_back(std::move(target));
+      }
+    }
+
+    for (auto& owner : owners) {
+      auto it = byOwner.find(owner.id());
+      owner.template setPreloadedMany<Target>(
+        Traits::name,
+        it == byOwner.end() ? std::vector<Target>{} : std::move(it->second)
+      );
+    }
+  }
+
+  template <typename Owner, typename Target>
+  void preload(std::vector<Owner>& owners) {
+    using Traits = AssociationTraits<Owner, Target>;
+
+    if constexpr (Traits::kind == AssociationKind::BelongsTo) {
+      preloadBelongsTo<Owner, Target>(owners);
+    } else {
+      preloadHasMany<Owner, Target>(owners);
+    }
+  }
+
+} // namespace Preloader
+
+// Run `query` and eager load the listed associations onto every returned model
+template <typename... Targets, typename Owner>
+std::vector<Owner> includes(Cyclone::QueryBuilder<Owner> query) {
+  auto owners = query.get();
+
+  if (!owners.empty()) {
+    (Preloader::preload<Owner, Targets>(owners), ...);
+  }
+
+  return owners;
+}
+
+// Eager load associations onto models that were already fetched
+template <typename... Targets, typename Owner>
+void preload(std::vector<Owner>& owners) {
+  if (!owners.empty()) {
+    (Preloader::preload<Owner, Targets>(owners), ...);
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "cyclone/model.hpp"
+#include "cyclone/database.hpp"
+#include "identity_map.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * Propagate changes to belongsTo parents by bumping their updated_at
+ *
+ *   belongsTo<Post>();
+ *   touches<Post>({.foreignKey = "post_id"});
+ *
+ * Fragment cache keys include updated_at, so touching the parent retires the
+ * parent's cached fragments while the child's own fragments stay valid.
+ * Call touchParents() from afterSave() and afterDestroy().
+ */
+
+struct TouchOptions {
+  std::string foreignKey;
+  std::string typeColumn = "";       // Polymorphic associations only
+  std::string polymorphicType = "";  // Value of typeColumn that selects this parent
+};
+
+struct TouchDefinition {
+  std::string childTable;
+  std::string parentTable;
+  TouchOptions options;
+};
+
+class Touches {
+public:
+  static std::vector<TouchDefinition>& definitions() {
+    static std::vector<TouchDefinition> registry;
+    return registry;
+  }
+
+  static void define(TouchDefinition definition) {
+    auto& registry = definitions();
+    for (const auto& existing : registry) {
+      if (existing.childTable == definition.childTable &&
+          existing.parentTable == definition.parentTable &&
+          existing.options.foreignKey == definition.options.foreignKey) {
+        return;
+      }
+    }
+    registry.push_back(std::move(definition));
+  }
+
+  static void touch(const std::string& table, int id) {
+    Cyclone::Database::execute(
+      "UPDATE " + table + " SET updated_at = ? WHERE id = ?",
+      {TimePoint::now(), id}
+    );
+    IdentityMap::evict(table, id);
+  }
+};
+
+template <typename Child>
+class Touching {
+protected:
+  template <typename Parent>
+  static void touches(TouchOptions options) {
+    Touches::define({Child::tableName(), Parent::tableName(), std::move(options)});
+  }
+
+  void touchParents() const {
+    const auto& child = static_cast<const Child&>(*this);
+
+    for (const auto& definition : Touches::definitions()) {
+      if (definition.childTable != Child::tableName()) {
+        continue;
+      }
+
+      const auto& options = definition.options;
+      if (!options.typeColumn.empty() &&
+          child.template get<std::string>(options.typeColumn) != options.polymorphicType) {
+        continue;
+      }
+
+      Touches::touch(definition.parentTable, child.template get<int>(options.foreignKey));
+    }
+  }
+};
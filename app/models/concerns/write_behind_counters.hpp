@@ -0,0 +1,352 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "counter_cache.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Write-behind counter caches
+ *
+ * For counters declared with `.writeBehind = true` (likes_count on posts and
+ * comments), a like or unlike no longer updates the parent row in the
+ * request. The child row itself is still written synchronously, so the unique
+ * (user_id, likeable_id, likeable_type) index keeps deciding whether a like
+ * exists. Only the hot parent UPDATE is deferred:
+ *
+ *   - add() bumps an in-memory delta for the parent (sharded map of atomics),
+ *     so the request can answer with `stored + pending` straight away;
+ *   - every `flushInterval` the dirty parents are recounted from the child
+ *     table in one transaction (`SET likes_count = (SELECT COUNT(*) ...)`),
+ *     which also bumps their updated_at for fragment caches. A recount is
+ *     idempotent, so a retried or replayed flush can never double count, and
+ *     each parent is recounted on two consecutive flushes to pick up rows
+ *     whose transaction was still open during the first. The deltas the
+ *     recount absorbed are only dropped once it has committed, so `stored +
+ *     pending` never goes back while a flush is in progress;
+ *   - the first time a parent becomes dirty it is appended to a small log.
+ *     After a crash, start() marks everything in the log dirty again and the
+ *     first flush recounts it.
+ *
+ *   WriteBehindCounters::start({.flushInterval = 1s, .logPath = "tmp/counters.log"});
+ *   ...
+ *   WriteBehindCounters::stop();   // final flush
+ *
+ * The log is not fsynced: it survives a process restart, not a power loss
+ * (run `bin/cy db:counters:rebuild` after one).
+ */
+
+class WriteBehindCounters : public DeferredCounterWriter {
+public:
+  struct Options {
+    std::chrono::milliseconds flushInterval{1000};
+    std::string logPath = "tmp/write_behind_counters.log";
+  };
+
+  static void start(Options options) {
+    auto& slot = instance();
+    if (slot) {
+      return;
+    }
+    slot.reset(new WriteBehindCounters(std::move(options)));
+    CounterCache::installDeferredWriter(slot.get());
+  }
+
+  // Flush what is pending and go back to synchronous counters; waits for
+  // requests still adding to this writer before destroying it
+  static void stop() {
+    auto& slot = instance();
+    if (!slot) {
+      return;
+    }
+    CounterCache::uninstallDeferredWriter();
+    slot.reset();
+  }
+
+  void add(size_t definition, int parentId, int delta) override {
+    auto key = keyOf(definition, parentId);
+    auto& shard = shardFor(key);
+
+    std::shared_lock rotation(rotationMutex_);
+    {
+      std::shared_lock lock(shard.mutex);
+      if (auto it = shard.deltas.find(key); it != shard.deltas.end()) {
+        it->second.fetch_add(delta, std::memory_order_relaxed);
+        return;
+      }
+    }
+
+    bool inserted = false;
+    {
+      std::unique_lock lock(shard.mutex);
+      auto [it, fresh] = shard.deltas.try_emplace(key, 0);
+      it->second.fetch_add(delta, std::memory_order_relaxed);
+      inserted = fresh;
+    }
+
+    if (inserted) {
+      log(definition, parentId);
+    }
+  }
+
+  int64_t pending(size_t definition, int parentId) const override {
+    auto key = keyOf(definition, parentId);
+    auto& shard = shardFor(key);
+
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.deltas.find(key);
+    return it == shard.deltas.end() ? 0 : it->second.load(std::memory_order_relaxed);
+  }
+
+  // Recount every dirty parent now; called by the flush thread
+  void flush() {
+    Dirty dirty;
+    Dirty recount;
+    Taken taken;
+    {
+      std::unique_lock rotation(rotationMutex_);
+      for (auto& shard : shards_) {
+        std::unique_lock lock(shard.mutex);
+        for (const auto& [key, delta] : shard.deltas) {
+          dirty[static_cast<size_t>(key >> 32)].push_back(static_cast<int>(key & 0xffffffffu));
+          taken.emplace_back(key, delta.load(std::memory_order_relaxed));
+        }
+      }
+      for (auto& [table, column, id] : recovered_) {
+        if (auto definition = definitionFor(table, column)) {
+          dirty[*definition].push_back(id);
+        }
+      }
+      recovered_.clear();
+
+      recount = dirty;
+      for (const auto& [definition, ids] : previous_) {
+        auto& merged = recount[definition];
+        merged.insert(merged.end(), ids.begin(), ids.end());
+      }
+      if (recount.empty()) {
+        return;
+      }
+
+      // This round's parents stay logged until the next flush recounts
+      // them a second time (see previous_)
+      rotateLog();
+      for (const auto& [definition, ids] : dirty) {
+        for (int id : ids) {
+          log(definition, id);
+        }
+      }
+    }
+
+    try {
+      const auto& registry = CounterCache::definitions();
+      Cyclone::Database::transaction([&]() {
+        for (auto& [definition, ids] : recount) {
+          std::sort(ids.begin(), ids.end());
+          ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+          CounterCache::rebuild(registry[definition], ids);
+        }
+      });
+      previous_ = std::move(dirty);
+      settle(taken);
+    } catch (const std::exception& e) {
+      // Their deltas are still pending; mark the recovered and previous
+      // parents dirty again (and log them anew) for the next flush
+      Logger::error("Write-behind counter flush failed, retrying: {}", e.what());
+      previous_.clear();
+      for (const auto& [definition, ids] : recount) {
+        for (int id : ids) {
+          add(definition, id, 0);
+        }
+      }
+    }
+    removeFlushing();
+  }
+
+  ~WriteBehindCounters() override {
+    {
+      std::lock_guard lock(stopMutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    flush();
+    if (logFd_ >= 0) {
+      ::close(logFd_);
+    }
+  }
+
+private:
+  static constexpr size_t kShards = 16;
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t, std::atomic<int64_t>> deltas;
+  };
+
+  // Definition index -> parent ids
+  using Dirty = std::map<size_t, std::vector<int>>;
+
+  // Deltas seen by a flush, keyed as in Shard::deltas
+  using Taken = std::vector<std::pair<uint64_t, int64_t>>;
+
+  struct Recovered {
+    std::string table;
+    std::string column;
+    int id;
+  };
+
+  explicit WriteBehindCounters(Options options) : options_(std::move(options)) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(options_.logPath).parent_path(), error);
+    recover(flushingPath());
+    recover(options_.logPath);
+    openLog();
+
+    // Carry recovered parents over to the new log until they are recounted
+    for (const auto& entry : recovered_) {
+      append(entry.table + " " + entry.column + " " + std::to_string(entry.id) + "\n");
+    }
+
+    thread_ = std::thread([this] { run(); });
+  }
+
+  static std::unique_ptr<WriteBehindCounters>& instance() {
+    static std::unique_ptr<WriteBehindCounters> slot;
+    return slot;
+  }
+
+  static uint64_t keyOf(size_t definition, int parentId) {
+    return (static_cast<uint64_t>(definition) << 32) | static_cast<uint32_t>(parentId);
+  }
+
+  Shard& shardFor(uint64_t key) const {
+    return shards_[(key * 0x9E3779B97F4A7C15ull) >> 60];
+  }
+
+  static std::optional<size_t> definitionFor(const std::string& table, const std::string& column) {
+    const auto& registry = CounterCache::definitions();
+    for (size_t i = 0; i < registry.size(); i++) {
+      if (registry[i].parentTable == table && registry[i].options.column == column) {
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void run() {
+    std::unique_lock lock(stopMutex_);
+    while (!stopping_) {
+      wake_.wait_for(lock, options_.flushInterval, [this] { return stopping_; });
+      if (stopping_) {
+        break;
+      }
+
+      lock.unlock();
+      flush();
+      lock.lock();
+    }
+  }
+
+  // Subtract what a committed recount absorbed; parents whose delta drops
+  // to zero are clean, anything added since the snapshot stays pending
+  void settle(const Taken& taken) {
+    for (const auto& [key, delta] : taken) {
+      auto& shard = shardFor(key);
+      std::unique_lock lock(shard.mutex);
+      if (auto it = shard.deltas.find(key); it != shard.deltas.end() &&
+          it->second.fetch_sub(delta, std::memory_order_relaxed) == delta) {
+        shard.deltas.erase(it);
+      }
+    }
+  }
+
+  // The log names dirty parents as "<table> <column> <id>" lines
+  void log(size_t definition, int parentId) {
+    const auto& entry = CounterCache::definitions()[definition];
+    append(entry.parentTable + " " + entry.options.column + " " + std::to_string(parentId) + "\n");
+  }
+
+  // Single O_APPEND writes of one short line do not interleave
+  void append(const std::string& line) {
+    if (logFd_ >= 0 && ::write(logFd_, line.data(), line.size()) < 0) {
+      Logger::error("Write-behind counter log write failed: {}", options_.logPath);
+    }
+  }
+
+  void openLog() {
+    logFd_ = ::open(options_.logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd_ < 0) {
+      Logger::error("Write-behind counters cannot open {}; restarts may lose pending counts", options_.logPath);
+    }
+  }
+
+  // Called with the rotation lock held exclusively: the entries being
+  // flushed move to the .flushing file, new ones start a fresh log
+  void rotateLog() {
+    if (logFd_ >= 0) {
+      ::close(logFd_);
+    }
+    std::error_code error;
+    std::filesystem::rename(options_.logPath, flushingPath(), error);
+    openLog();
+  }
+
+  void recover(const std::string& path) {
+    std::ifstream in(path);
+    Recovered entry;
+    while (in >> entry.table >> entry.column >> entry.id) {
+      recovered_.push_back(entry);
+    }
+    in.close();
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+  }
+
+  void removeFlushing() {
+    std::error_code error;
+    std::filesystem::remove(flushingPath(), error);
+  }
+
+  std::string flushingPath() const {
+    return options_.logPath + ".flushing";
+  }
+
+  Options options_;
+  mutable std::array<Shard, kShards> shards_;
+  std::shared_mutex rotationMutex_;   // Shared by add(), exclusive while flush() swaps logs
+  std::vector<Recovered> recovered_;
+  // Parents recounted by the last flush are recounted once more by the next
+  // one: a like committed just after a recount (its delta was added inside
+  // the transaction, before the row was visible) is then still counted
+  Dirty previous_;
+  int logFd_ = -1;
+
+  std::mutex stopMutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
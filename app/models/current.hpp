@@ -0,0 +1,62 @@
+#pragma once
+
+#include "user.hpp"
+#include <optional>
+
+/**
+ * Request-scoped "current" attributes
+ *
+ * The signed-in user is resolved from the session once per request and shared
+ * by AdminAuthMiddleware, ApplicationController::currentUser() and
+ * ApplicationHelper::currentUser(). RequestScopeMiddleware opens a Scope around
+ * each request; the memo is keyed on the session's user_id, so logging in or
+ * out mid-request resolves again.
+ */
+class Current {
+  struct State {
+    bool active = false;
+    bool userResolved = false;
+    std::optional<int> userId;
+    std::optional<User> user;
+  };
+
+public:
+  class Scope {
+  public:
+    Scope() : previous_(std::move(state())) { state() = State{.active = true}; }
+    ~Scope() { state() = std::move(previous_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    State previous_;
+  };
+
+  // The signed-in user, or std::nullopt. The reference stays valid until the
+  // end of the request (or the next call with a different session user).
+  template <typename Session>
+  static const std::optional<User>& user(const Session& session) {
+    auto& current = state();
+
+    std::optional<int> userId;
+    if (session.has("user_id")) {
+      userId = session.template get<int>("user_id");
+    }
+
+    // Outside a request scope nothing is memoized
+    if (!current.active || !current.userResolved || current.userId != userId) {
+      current.userId = userId;
+      current.user = userId ? User::find(*userId) : std::nullopt;
+      current.userResolved = true;
+    }
+
+    return current.user;
+  }
+
+private:
+  static State& state() {
+    thread_local State current;
+    return current;
+  }
+};
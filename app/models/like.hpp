@@ -4,8 +4,14 @@
 #include "user.hpp"
 #include "post.hpp"
 #include "comment.hpp"
+#include "concerns/counter_cache.hpp"
+#include "concerns/touching.hpp"
+#include "concerns/bulk_writable.hpp"
 
-class Like : public Cyclone::Model<Like> {
+class Like : public Cyclone::Model<Like>,
+             public CounterCached<Like>,
+             public Touching<Like>,
+             public BulkWritable<Like> {
 public:
     static void defineSchema() {
         schema()
@@ -19,6 +25,27 @@ public:
         belongsTo<User>();
         polymorphicBelongsTo("likeable", {{"Post", "Comment"}});
 
+        // Keep posts.likes_count and comments.likes_count in sync; deferred
+        // to the periodic flush when WriteBehindCounters is running
+        counterCache<Post>({
+          .column = "likes_count",
+          .foreignKey = "likeable_id",
+          .typeColumn = "likeable_type",
+          .polymorphicType = "Post",
+          .writeBehind = true
+        });
+        counterCache<Comment>({
+          .column = "likes_count",
+          .foreignKey = "likeable_id",
+          .typeColumn = "likeable_type",
+          .polymorphicType = "Comment",
+          .writeBehind = true
+        });
+
+        // Like counts are part of cached post cards and comments
+        touches<Post>({.foreignKey = "likeable_id", .typeColumn = "likeable_type", .polymorphicType = "Post"});
+        touches<Comment>({.foreignKey = "likeable_id", .typeColumn = "likeable_type", .polymorphicType = "Comment"});
+
         // Define unique index
         uniqueIndex({"user_id", "likeable_id", "likeable_type"});
     }
@@ -31,6 +58,75 @@ public:
         validates("uniqueness", {.scope = {"user_id", "likeable_id", "likeable_type"}});
     }
 
+    // Callbacks
+    void afterCreate() {
+        incrementCounterCaches();
+    }
+
+    void afterSave() {
+        touchParents();
+    }
+
+    void afterDestroy() {
+        decrementCounterCaches();
+        touchParents();
+    }
+
+    // Insert the like unless it exists, relying on the unique index rather
+    // than a lookup first; false when the user had already liked it. Runs the
+    // counter cache and touch effects that the bulk insert skips (the
+    // write-behind flush touches the parent itself).
+    static bool likeOnce(int userId, int likeableId, const std::string& likeableType) {
+        Attributes attributes = {
+            {"user_id", userId},
+            {"likeable_id", likeableId},
+            {"likeable_type", likeableType}
+        };
+
+        bool created = false;
+        Cyclone::Database::transaction([&]() {
+            created = insertAll({attributes}, {.validate = false, .skipDuplicates = true}).written > 0;
+            if (created) {
+                auto like = Like::new_(attributes);
+                like.incrementCounterCaches();
+                if (!CounterCache::deferred()) {
+                    like.touchParents();
+                }
+            }
+        });
+        return created;
+    }
+
+    // Delete the like if it exists; false when there was none
+    static bool unlikeOnce(int userId, int likeableId, const std::string& likeableType) {
+        bool removed = false;
+        Cyclone::Database::transaction([&]() {
+            removed = Cyclone::Database::execute(
+                "DELETE FROM likes WHERE user_id = ? AND likeable_id = ? AND likeable_type = ?",
+                {userId, likeableId, likeableType}
+            ) > 0;
+            if (removed) {
+                auto like = Like::new_({
+                    {"user_id", userId},
+                    {"likeable_id", likeableId},
+                    {"likeable_type", likeableType}
+                });
+                like.decrementCounterCaches();
+                if (!CounterCache::deferred()) {
+                    like.touchParents();
+                }
+            }
+        });
+        return removed;
+    }
+
+    // likes_count as the client should see it: the stored column plus any
+    // write-behind delta not flushed yet
+    static int displayedCount(const std::string& likeableType, int likeableId, int storedCount) {
+        auto table = likeableType == "Post" ? Post::tableName() : Comment::tableName();
+        return storedCount + static_cast<int>(CounterCache::pending(table, "likes_count", likeableId));
+    }
+
     // Scopes
     static QueryBuilder<Like> forPost(int postId) {
         return where("likeable_type", "Post").where("likeable_id", postId);
@@ -1,10 +1,23 @@
 #pragma once
 
 #include "cyclone/model.hpp"
+#include "concerns/preloadable.hpp"
+#include "concerns/identity_map.hpp"
+#include "concerns/bulk_writable.hpp"
+#include "database/record.hpp"
 #include "user.hpp"
 
-class Post : public Cyclone::Model<Post> {
+class Comment;
+class Like;
+
+class Post : public Cyclone::Model<Post>,
+             public Preloadable<Post>,
+             public IdentityMapped<Post>,
+             public BulkWritable<Post> {
 public:
+    // Loaded at most once per request
+    using IdentityMapped<Post>::find;
+
     static void defineSchema() {
         schema()
           .field<int>("id", {.primaryKey = true, .autoIncrement = true})
@@ -13,6 +26,8 @@ public:
           .field<std::string>("content", {.nullable = false})
           .field<bool>("published", {.default_ = false})
           .field<TimePoint>("published_at")
+          .field<int>("comments_count", {.default_ = 0})
+          .field<int>("likes_count", {.default_ = 0})
           .timestamps();
 
         // Define relationships
@@ -45,12 +60,89 @@ public:
         }
     }
 
-    // Methods
+    void afterSave() {
+        rememberIdentity();
+    }
+
+    void afterDestroy() {
+        forgetIdentity();
+    }
+
+    // Associations (served from the eager-loaded set when available)
+    // User::placeholder() when the author's row is gone
+    User user() const {
+        if (auto preloadedUser = preloaded<User>("user")) {
+            return preloadedUser->has_value() ? **preloadedUser : User::placeholder();
+        }
+        auto user = User::find(userId());
+        return user ? *user : User::placeholder();
+    }
+
+    // Methods (counter cache columns maintained by Comment and Like)
     int commentCount() const {
-        return comments().count();
+        return commentsCount();
     }
 
     int likeCount() const {
-        return likes().count();
+        return likesCount();
     }
+
+    // Stands in for the post of a comment whose post row is gone
+    static Post placeholder() {
+        Post post;
+        post.setTitle("Deleted post");
+        return post;
+    }
+};
+
+// The posts table as a flat struct, for exports and other walks over many
+// rows that need no associations or callbacks (see lib/database/record.hpp)
+struct PostRow : Record<PostRow> {
+    static constexpr const char* table = "posts";
+
+    int id = 0;
+    int user_id = 0;
+    std::string title;
+    std::string content;
+    bool published = false;
+    std::optional<TimePoint> published_at;
+    int comments_count = 0;
+    int likes_count = 0;
+    std::optional<TimePoint> created_at;
+    std::optional<TimePoint> updated_at;
+
+    static constexpr auto fields() {
+        return std::tuple{
+            Projection::field("id", &PostRow::id),
+            Projection::field("user_id", &PostRow::user_id),
+            Projection::field("title", &PostRow::title),
+            Projection::field("content", &PostRow::content),
+            Projection::field("published", &PostRow::published),
+            Projection::field("published_at", &PostRow::published_at),
+            Projection::field("comments_count", &PostRow::comments_count),
+            Projection::field("likes_count", &PostRow::likes_count),
+            Projection::field("created_at", &PostRow::created_at),
+            Projection::field("updated_at", &PostRow::updated_at)
+        };
+    }
+};
+
+template <> struct AssociationTraits<Post, User> {
+    static constexpr auto kind = AssociationKind::BelongsTo;
+    static constexpr const char* name = "user";
+    static constexpr const char* foreignKey = "user_id";
+};
+
+template <> struct AssociationTraits<Post, Comment> {
+    static constexpr auto kind = AssociationKind::HasMany;
+    static constexpr const char* name = "comments";
+    static constexpr const char* foreignKey = "post_id";
+};
+
+template <> struct AssociationTraits<Post, Like> {
+    static constexpr auto kind = AssociationKind::HasMany;
+    static constexpr const char* name = "likes";
+    static constexpr const char* foreignKey = "likeable_id";
+    static constexpr const char* typeColumn = "likeable_type";
+    static constexpr const char* polymorphicType = "Post";
 };
\ No newline at end of file
@@ -2,9 +2,19 @@
 
 #include "cyclone/model.hpp"
 #include "cyclone/engines/fortress/authenticatable.hpp"
+#include "concerns/identity_map.hpp"
+#include "concerns/bulk_writable.hpp"
+#include "database/projection.hpp"
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
-class User : public Cyclone::Model<User> {
+class User : public Cyclone::Model<User>, public IdentityMapped<User>, public BulkWritable<User> {
 public:
+  // Loaded at most once per request
+  using IdentityMapped<User>::find;
+
   static void defineSchema() {
     schema()
       .field<int>("id", {.primaryKey = true, .autoIncrement = true})
@@ -68,8 +78,83 @@ public:
     .extend_remember_period = true
   });
 
+  // Ids of the users with these names, in one `WHERE name IN (...)` query.
+  // With `cached`, name -> id pairs are kept in the cache for a minute, next
+  // to an id -> name entry that lets afterSave() drop the pair on a rename.
+  static std::unordered_map<std::string, int> idsByName(const std::vector<std::string_view>& names,
+                                                        bool cached = false) {
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> missing;
+
+    for (auto name : names) {
+      if (cached) {
+        if (auto id = Cyclone::Cache::read(nameCacheKey(name))) {
+          ids.emplace(name, std::stoi(*id));
+          continue;
+        }
+      }
+      missing.emplace_back(name);
+    }
+
+    if (!missing.empty()) {
+      for (auto& [id, name] : pluck<int, std::string>(where("name", "IN", missing), "id", "name")) {
+        if (cached) {
+          Cyclone::Cache::write(nameCacheKey(name), std::to_string(id), std::chrono::minutes(1));
+          Cyclone::Cache::write(cachedNameKey(id), name, std::chrono::minutes(1));
+        }
+        ids.emplace(std::move(name), id);
+      }
+    }
+
+    return ids;
+  }
+
+  // Callbacks
+  void afterSave() {
+    rememberIdentity();
+    Cyclone::Cache::remove(nameCacheKey(name()));
+
+    // The name idsByName() cached for this id, if it was renamed since
+    if (auto cachedName = Cyclone::Cache::read(cachedNameKey(id())); cachedName && *cachedName != name()) {
+      Cyclone::Cache::remove(nameCacheKey(*cachedName));
+      Cyclone::Cache::remove(cachedNameKey(id()));
+    }
+  }
+
+  void afterDestroy() {
+    forgetIdentity();
+  }
+
+  static std::string nameCacheKey(std::string_view name) {
+    return "users/id_by_name/" + std::string(name);
+  }
+
+  static std::string cachedNameKey(int id) {
+    return "users/name_by_id/" + std::to_string(id);
+  }
+
   // Authorization helpers
   bool isAdmin() const {
     return role() == "admin";
   }
+
+  // Stands in for the author of a post or comment whose user row is gone
+  static User placeholder() {
+    User user;
+    user.setName("Deleted user");
+    return user;
+  }
+};
+
+// Just enough of a user for a select box: select<UserOption>(User::query())
+struct UserOption {
+  int id = 0;
+  std::string name;
+
+  static constexpr auto fields() {
+    return std::tuple{
+      Projection::field("users.id", &UserOption::id),
+      Projection::field("users.name", &UserOption::name)
+    };
+  }
 };
\ No newline at end of file
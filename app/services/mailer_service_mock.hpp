@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <stdexcept>
 
 /**
  * Mock implementation of MailerService for testing
@@ -19,6 +20,7 @@ public:
     };
 
     std::vector<SentEmail> sentEmails;
+    bool failTemplates = false;  // Make sendTemplate() throw, as an unreachable SMTP server would
 
     // Record email instead of sending it
     bool send(const std::string& to, const std::string& subject, const std::string& body) override {
@@ -38,6 +40,10 @@ public:
       const std::string& templateName,
       const std::map<std::string, std::string>& templateData
     ) override {
+        if (failTemplates) {
+            throw std::runtime_error("MailerServiceMock: SMTP unavailable");
+        }
+
         SentEmail email;
         email.recipient = to;
         email.subject = subject;
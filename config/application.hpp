@@ -4,6 +4,18 @@
 #include "cyclone/engines/dash.hpp"
 #include "cyclone/engines/pulse.hpp"
 #include "cyclone/engines/fortress.hpp"
+#include "cache/sharded_memory_store.hpp"
+#include "middleware/pipeline.hpp"
+#include "session/lazy_cookie_store.hpp"
+#include "database/seek_pagination.hpp"
+#include "jobs/work_stealing_pool.hpp"
+#include "jobs/outbox.hpp"
+#include "../app/middleware/request_scope_middleware.hpp"
+#include "../app/middleware/replica_routing_middleware.hpp"
+#include "views/compiled_view.hpp"
+#include "../app/models/like.hpp"
+#include "../app/models/concerns/write_behind_counters.hpp"
+#include "../app/jobs/notification_job.hpp"
 
 class Application : public Cyclone::Application {
 public:
@@ -25,16 +37,54 @@ public:
     setPort(3000);
     setForceSSL(false); // Set to true in production
 
-    // Configure session
-    setSessionStore(Cyclone::SessionStore::Cookie, {
+    // Configure session: signed cookie, verified only when the session is
+    // read and re-signed only when it changes
+    setSessionStore(std::make_shared<Sessions::LazyCookieStore>(Sessions::StoreOptions{
       {"key", "cyclone_session"},
       {"secret", getEnv("SESSION_SECRET", "development_secret")},
       {"max_age", "2592000"} // 30 days
-    });
+    }));
+
+    // Key for signing pagination cursors
+    SeekCursor::configure(getEnv("CURSOR_SECRET", getEnv("SESSION_SECRET", "development_secret")));
 
-    // Configure cache
-    setCacheStore(Cyclone::CacheStore::Memory, {
+    // Configure cache: lock-striped shards with W-TinyLFU admission, so worker
+    // threads don't serialise on one LRU and admin scans can't flush it
+    setCacheStore(std::make_shared<Caching::ShardedMemoryStore>(Caching::StoreOptions{
       {"size_mb", "64"}
+    }));
+
+    // Serve views compiled at build time by cyc_compile; templates without a
+    // <%@ locals %> directive fall back to the interpreter
+    setViewRenderer(std::make_shared<CompiledViews::Renderer>());
+
+    // Optionally defer like counters: likes_count is recounted for the
+    // posts/comments touched in each LIKE_COUNTERS_FLUSH_MS window instead of
+    // being updated by every like/unlike request
+    if (getEnv("LIKE_COUNTERS_WRITE_BEHIND") == "1") {
+      Like::defineSchema();
+      WriteBehindCounters::start({
+        .flushInterval = std::chrono::milliseconds(std::stoi(getEnv("LIKE_COUNTERS_FLUSH_MS", "1000"))),
+        .logPath = getEnv("LIKE_COUNTERS_LOG", "tmp/like_counters.log")
+      });
+    }
+
+    // Comment, like and mention emails are batched into one digest per
+    // recipient and type per window; 0 sends each one on its own
+    NotificationDigest::configure(std::chrono::seconds(std::stoi(getEnv("NOTIFICATION_DIGEST_SECONDS", "300"))));
+
+    // Reschedule digests whose window is still open well past its flush_at,
+    // i.e. whose job was lost
+    if (NotificationDigest::enabled()) {
+      NotificationDigest::startSweeper({
+        .interval = std::chrono::seconds(std::stoi(getEnv("NOTIFICATION_SWEEP_SECONDS", "60"))),
+        .grace = std::chrono::seconds(std::stoi(getEnv("NOTIFICATION_SWEEP_GRACE_SECONDS", "300")))
+      }, &NotificationJob::resumeDigests);
+    }
+
+    // Hand jobs enqueued inside transactions over to Pulse once committed
+    Jobs::Outbox::start({
+      .pollInterval = std::chrono::milliseconds(std::stoi(getEnv("JOB_OUTBOX_POLL_MS", "200")))
     });
 
     // Mount engines
@@ -48,6 +98,13 @@ public:
     addAutoloadPath("lib");
   }
 
+  ~Application() {
+    // Final flush of any deferred counters and outbox jobs
+    WriteBehindCounters::stop();
+    NotificationDigest::stopSweeper();
+    Jobs::Outbox::stop();
+  }
+
 private:
   void mountEngines() {
     // Mount the Dash admin engine
@@ -59,12 +116,23 @@ private:
       .custom_dashboards = true
     });
 
-    // Mount the Pulse job processing engine
+    // Mount the Pulse job processing engine. Jobs are leased and acked
+    // PULSE_DEQUEUE_BATCH at a time; workers (`bin/cy pulse -w N`) steal from
+    // each other and serve strict lanes: mail and notifications first,
+    // sharing 2:1, then default, then reports
     mount(Cyclone::Engines::Pulse::Engine, {
       .path = "/pulse",
       .access = Cyclone::Engines::Pulse::AccessLevel::AdminOnly,
       .retention_days = 7,
-      .queues = {"default", "mailers", "reports"}
+      .queues = {"default", "mailers", "notifications", "reports"},
+      .dequeue_batch = static_cast<size_t>(std::stoi(getEnv("PULSE_DEQUEUE_BATCH", "64"))),
+      .executor = [this](size_t workers) {
+        return std::make_shared<Jobs::WorkStealingPool>(Jobs::PoolOptions{
+          .workers = workers,
+          .queues = {{"mailers", 0, 2}, {"notifications", 0, 1}, {"default", 1}, {"reports", 2}},
+          .pinThreads = getEnv("PULSE_PIN_WORKERS") == "1"
+        });
+      }
     });
 
     // Mount the Fortress authentication engine
@@ -85,31 +153,52 @@ private:
   }
 
   void registerMiddleware() {
-    // Add middleware for all environments
-    use(Cyclone::Middleware::RequestLogger);
-    use(Cyclone::Middleware::MethodOverride);
-    use(Cyclone::Middleware::ParamsParser);
-    use(Cyclone::Middleware::Cookies);
-    use(Cyclone::Middleware::Sessions);
-    use(Cyclone::Middleware::FlashMessages);
+    using Pipelines::Adapted;
 
     // Environment-specific middleware
     if (isDevelopment()) {
-      use(Cyclone::Middleware::Reloader);
-      use(Cyclone::Middleware::ErrorPages, {
-        {"detailed", "true"}
-      });
+      useMiddleware(
+        Adapted<Cyclone::Middleware::Reloader>{},
+        Adapted<Cyclone::Middleware::ErrorPages>(std::map<std::string, std::string>{
+          {"detailed", "true"}
+        })
+      );
+    } else if (isProduction()) {
+      useMiddleware(
+        Adapted<Cyclone::Middleware::ErrorPages>{},
+        Adapted<Cyclone::Middleware::HttpCache>{},
+        Adapted<Cyclone::Middleware::SecurityHeaders>{},
+        Adapted<Cyclone::Middleware::ForceSSL>{}
+      );
     } else {
-      use(Cyclone::Middleware::ErrorPages);
-      use(Cyclone::Middleware::HttpCache);
-
-      if (isProduction()) {
-        use(Cyclone::Middleware::SecurityHeaders);
-        use(Cyclone::Middleware::ForceSSL);
-      }
+      useMiddleware(
+        Adapted<Cyclone::Middleware::ErrorPages>{},
+        Adapted<Cyclone::Middleware::HttpCache>{}
+      );
     }
   }
 
+  // Install the middleware for all environments followed by `tail` as one
+  // statically composed pipeline. CYCLONE_MIDDLEWARE_TIMING=1 logs the time
+  // spent in each layer per request.
+  template <typename... Tail>
+  void useMiddleware(Tail... tail) {
+    using Pipelines::Adapted;
+
+    use(Pipelines::makePipeline(
+      {.timing = getEnv("CYCLONE_MIDDLEWARE_TIMING") == "1"},
+      RequestScopeMiddleware{},
+      Adapted<Cyclone::Middleware::RequestLogger>{},
+      Adapted<Cyclone::Middleware::MethodOverride>{},
+      Adapted<Cyclone::Middleware::ParamsParser>{},
+      Adapted<Cyclone::Middleware::Cookies>{},
+      ReplicaRoutingMiddleware{},
+      Adapted<Cyclone::Middleware::Sessions>{},
+      Adapted<Cyclone::Middleware::FlashMessages>{},
+      std::move(tail)...
+    ));
+  }
+
   std::string getEnv(const std::string& key, const std::string& defaultValue = "") {
     auto value = std::getenv(key.c_str());
     return value ? std::string(value) : defaultValue;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "cyclone/database.hpp"
+#include "database/statement_cache.hpp"
+#include "database/replica_routing.hpp"
 
 void configureDatabases() {
   using namespace Cyclone::Database;
@@ -37,6 +39,12 @@ void configureDatabases() {
     };
   }
 
+  // Keep an LRU of prepared statements on every pooled connection, keyed on
+  // the SQL shape QueryBuilder generates
+  defaultConfig.statement_provider = Statements::perConnectionLru({
+    .capacity = static_cast<size_t>(std::stoi(getEnv("DB_STATEMENT_CACHE_SIZE", "256")))
+  });
+
   // Configure the default connection
   configure(defaultConfig);
 
@@ -53,11 +61,19 @@ void configureDatabases() {
       .pool_size = std::stoi(getEnv("DB_REPLICA_POOL_SIZE", "5")),
       .timeout = std::chrono::seconds(std::stoi(getEnv("DB_REPLICA_TIMEOUT", "5"))),
       .ssl_mode = getEnv("DB_REPLICA_SSL_MODE", "prefer"),
-      .read_only = true
+      .read_only = true,
+      .statement_provider = defaultConfig.statement_provider
     };
 
     // Register the replica connection
     configure(replicaConfig, "replica");
+
+    // Route reads to it automatically (see lib/database/replica_routing.hpp)
+    Replicas::install({
+      .replica = "replica",
+      .maxLag = std::chrono::milliseconds(std::stoi(getEnv("DB_REPLICA_MAX_LAG_MS", "2000"))),
+      .stickiness = std::chrono::milliseconds(std::stoi(getEnv("DB_REPLICA_STICKINESS_MS", "2000")))
+    });
   }
 }
 
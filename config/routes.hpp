@@ -10,6 +10,7 @@
 #include "../app/controllers/admin/posts_controller.hpp"
 #include "../app/controllers/admin/users_controller.hpp"
 #include "../app/middleware/admin_auth_middleware.hpp"
+#include "../lib/routing/radix_dispatcher.hpp"
 
 using namespace Cyclone;
 
@@ -54,6 +55,7 @@ void configureRoutes(Router& router) {
 
     // Admin dashboard
     r.get("/", &Admin::DashboardController::index);
+    r.get("/metrics/statements", &Admin::DashboardController::statements);
 
     // Admin CRUD for posts
     r.resources("posts", Admin::PostsController);
@@ -84,4 +86,8 @@ void configureRoutes(Router& router) {
   router.internalError(&ErrorsController::internalError);
   router.forbidden(&ErrorsController::forbidden);
   router.unauthorized(&ErrorsController::unauthorized);
+
+  // Dispatch through a flattened radix trie built from the routes above
+  // (generated at build time by tools/route_gen when available)
+  router.setDispatcher(std::make_shared<Routing::RadixDispatcher>(router.routes()));
 }
\ No newline at end of file
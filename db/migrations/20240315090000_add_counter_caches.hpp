@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cyclone/migration.hpp"
+
+namespace Migrations {
+
+    class AddCounterCaches : public Cyclone::Migration {
+    public:
+        void up() override {
+            changeTable("posts", [](Cyclone::Schema::Table& t) {
+              t.integer("comments_count", {.default_ = 0});
+              t.integer("likes_count", {.default_ = 0});
+            });
+
+            changeTable("comments", [](Cyclone::Schema::Table& t) {
+              t.integer("likes_count", {.default_ = 0});
+            });
+
+            // Backfill existing rows (same queries as bin/cy db:counters:rebuild)
+            execute("UPDATE posts SET comments_count = "
+                    "(SELECT COUNT(*) FROM comments WHERE comments.post_id = posts.id)");
+            execute("UPDATE posts SET likes_count = "
+                    "(SELECT COUNT(*) FROM likes WHERE likes.likeable_id = posts.id AND likes.likeable_type = 'Post')");
+            execute("UPDATE comments SET likes_count = "
+                    "(SELECT COUNT(*) FROM likes WHERE likes.likeable_id = comments.id AND likes.likeable_type = 'Comment')");
+        }
+
+        void down() override {
+            changeTable("comments", [](Cyclone::Schema::Table& t) {
+              t.removeColumn("likes_count");
+            });
+
+            changeTable("posts", [](Cyclone::Schema::Table& t) {
+              t.removeColumn("likes_count");
+              t.removeColumn("comments_count");
+            });
+        }
+    };
+
+} // namespace Migrations
+
+// Register migration
+CYCLONE_REGISTER_MIGRATION(Migrations::AddCounterCaches, 20240315090000);
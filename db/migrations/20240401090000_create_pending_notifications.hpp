@@ -0,0 +1,50 @@
+#pragma once
+
+#include "cyclone/migration.hpp"
+
+namespace Migrations {
+
+    class CreatePendingNotifications : public Cyclone::Migration {
+    public:
+        void up() override {
+            // Notification events waiting for their recipient's digest
+            createTable("pending_notifications", [](Cyclone::Schema::Table& t) {
+              t.integer("id", {.primaryKey = true, .autoIncrement = true});
+              t.integer("user_id", {.nullable = false});
+              t.integer("type", {.nullable = false});
+              t.integer("source_user_id", {.nullable = false});
+              t.integer("post_id", {.default_ = 0});
+              t.integer("comment_id", {.default_ = 0});
+              t.datetime("created_at");
+
+              t.foreignKey("user_id", {
+                .table = "users",
+                .column = "id",
+                .onDelete = Cyclone::Schema::ForeignKeyAction::Cascade,
+                .onUpdate = Cyclone::Schema::ForeignKeyAction::Cascade
+              });
+            });
+
+            // One row per open (recipient, type) window. `adds` counts the
+            // statements that added events to it; 1 for the one that opened it.
+            createTable("notification_windows", [](Cyclone::Schema::Table& t) {
+              t.integer("user_id", {.nullable = false});
+              t.integer("type", {.nullable = false});
+              t.datetime("flush_at", {.nullable = false});
+              t.integer("adds", {.default_ = 1});
+            });
+
+            addIndex("pending_notifications", {"user_id", "type"});
+            addUniqueIndex("notification_windows", {"user_id", "type"});
+        }
+
+        void down() override {
+            dropTable("notification_windows");
+            dropTable("pending_notifications");
+        }
+    };
+
+} // namespace Migrations
+
+// Register migration
+CYCLONE_REGISTER_MIGRATION(Migrations::CreatePendingNotifications, 20240401090000);
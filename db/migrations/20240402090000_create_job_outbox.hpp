@@ -0,0 +1,29 @@
+#pragma once
+
+#include "cyclone/migration.hpp"
+
+namespace Migrations {
+
+    class CreateJobOutbox : public Cyclone::Migration {
+    public:
+        void up() override {
+            // Jobs enqueued inside a transaction, waiting for the relay to
+            // hand them to Pulse (lib/jobs/outbox.hpp). `params` holds the
+            // binary-archived Params (lib/jobs/binary_archive.hpp).
+            createTable("job_outbox", [](Cyclone::Schema::Table& t) {
+              t.integer("id", {.primaryKey = true, .autoIncrement = true});
+              t.string("job", {.nullable = false});
+              t.binary("params", {.nullable = false});
+              t.datetime("available_at", {.nullable = false});
+            });
+        }
+
+        void down() override {
+            dropTable("job_outbox");
+        }
+    };
+
+} // namespace Migrations
+
+// Register migration
+CYCLONE_REGISTER_MIGRATION(Migrations::CreateJobOutbox, 20240402090000);
@@ -36,6 +36,8 @@ void define(Cyclone::Schema& schema) {
     t.text("content", {.nullable = false});
     t.boolean("published", {.default_ = false});
     t.datetime("published_at");
+    t.integer("comments_count", {.default_ = 0});
+    t.integer("likes_count", {.default_ = 0});
     t.datetime("created_at");
     t.datetime("updated_at");
 
@@ -52,6 +54,7 @@ void define(Cyclone::Schema& schema) {
     t.integer("user_id", {.nullable = false});
     t.integer("post_id", {.nullable = false});
     t.text("content", {.nullable = false});
+    t.integer("likes_count", {.default_ = 0});
     t.datetime("created_at");
     t.datetime("updated_at");
 
@@ -86,6 +89,37 @@ void define(Cyclone::Schema& schema) {
     });
   });
 
+  schema.createTable("pending_notifications", [](Cyclone::Schema::Table& t) {
+    t.integer("id", {.primaryKey = true, .autoIncrement = true});
+    t.integer("user_id", {.nullable = false});
+    t.integer("type", {.nullable = false});
+    t.integer("source_user_id", {.nullable = false});
+    t.integer("post_id", {.default_ = 0});
+    t.integer("comment_id", {.default_ = 0});
+    t.datetime("created_at");
+
+    t.foreignKey("user_id", {
+      .table = "users",
+      .column = "id",
+      .onDelete = Cyclone::Schema::ForeignKeyAction::Cascade,
+      .onUpdate = Cyclone::Schema::ForeignKeyAction::Cascade
+    });
+  });
+
+  schema.createTable("notification_windows", [](Cyclone::Schema::Table& t) {
+    t.integer("user_id", {.nullable = false});
+    t.integer("type", {.nullable = false});
+    t.datetime("flush_at", {.nullable = false});
+    t.integer("adds", {.default_ = 1});
+  });
+
+  schema.createTable("job_outbox", [](Cyclone::Schema::Table& t) {
+    t.integer("id", {.primaryKey = true, .autoIncrement = true});
+    t.string("job", {.nullable = false});
+    t.binary("params", {.nullable = false});
+    t.datetime("available_at", {.nullable = false});
+  });
+
   // Add indexes
   schema.addIndex("users", "email");
   schema.addIndex("users", "reset_password_token");
@@ -103,6 +137,9 @@ void define(Cyclone::Schema& schema) {
   schema.addIndex("likes", "user_id");
   schema.addIndex("likes", {"likeable_id", "likeable_type"});
   schema.addUniqueIndex("likes", {"user_id", "likeable_id", "likeable_type"});
+
+  schema.addIndex("pending_notifications", {"user_id", "type"});
+  schema.addUniqueIndex("notification_windows", {"user_id", "type"});
 }
 
 } // namespace Schema
\ No newline at end of file
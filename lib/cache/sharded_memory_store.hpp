@@ -0,0 +1,411 @@
+#pragma once
+
+#include "cyclone/cache.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Caching {
+
+/**
+ * Sharded in-memory cache store
+ *
+ * Keys are spread over a power-of-two number of shards, each with its own
+ * mutex, so concurrent workers rarely contend on the same lock. Every shard is
+ * a W-TinyLFU cache:
+ *
+ *   window LRU (1%)  ->  admission filter  ->  segmented LRU (probation 20%, protected 80%)
+ *
+ * New entries land in the small window. When the window overflows, its oldest
+ * entry only makes it into the main segments if the frequency sketch says it is
+ * requested more often than the entry it would evict, so a one-off scan (admin
+ * listings, crawlers) cannot flush the working set.
+ *
+ * Sizes are charged in bytes (key + value + per-entry bookkeeping) against
+ * `size_mb`, divided evenly between shards.
+ *
+ *   setCacheStore(std::make_shared<Caching::ShardedMemoryStore>(Caching::StoreOptions{
+ *     {"size_mb", "64"},
+ *     {"shards", "16"}   // optional, defaults to 4 x hardware threads
+ *   }));
+ */
+
+using StoreOptions = std::map<std::string, std::string>;
+
+struct ShardStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;   // Entries dropped for space, including rejected admissions
+  uint64_t expirations = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t capacity = 0;
+};
+
+// Count-min sketch of 4-bit counters, four rows packed into each 64-bit word.
+// Counters are halved every `sampleSize` increments so that popularity decays.
+class FrequencySketch {
+public:
+  explicit FrequencySketch(size_t expectedEntries) {
+    size_t width = std::bit_ceil(std::max<size_t>(expectedEntries, 64));
+    table_.assign(width, 0);
+    mask_ = width - 1;
+    sampleSize_ = width * 10;
+  }
+
+  void increment(uint64_t hash) {
+    bool added = false;
+    for (int row = 0; row < 4; ++row) {
+      auto [word, shift] = locate(hash, row);
+      if (((table_[word] >> shift) & 0xF) < 15) {
+        table_[word] += uint64_t{1} << shift;
+        added = true;
+      }
+    }
+
+    if (added && ++additions_ >= sampleSize_) {
+      reset();
+    }
+  }
+
+  int frequency(uint64_t hash) const {
+    int frequency = 15;
+    for (int row = 0; row < 4; ++row) {
+      auto [word, shift] = locate(hash, row);
+      frequency = std::min(frequency, static_cast<int>((table_[word] >> shift) & 0xF));
+    }
+    return frequency;
+  }
+
+  void clear() {
+    std::fill(table_.begin(), table_.end(), 0);
+    additions_ = 0;
+  }
+
+private:
+  static constexpr std::array<uint64_t, 4> kSeeds = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+  };
+
+  // Row `row` uses nibbles 4*row .. 4*row+3 of the selected word
+  std::pair<size_t, unsigned> locate(uint64_t hash, int row) const {
+    uint64_t h = (hash + kSeeds[row]) * kSeeds[row];
+    h ^= h >> 32;
+    auto nibble = static_cast<unsigned>(row * 4 + (h >> 62));
+    return {static_cast<size_t>(h & mask_), nibble * 4};
+  }
+
+  void reset() {
+    for (auto& word : table_) {
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    additions_ /= 2;
+  }
+
+  std::vector<uint64_t> table_;
+  size_t mask_ = 0;
+  size_t sampleSize_ = 0;
+  size_t additions_ = 0;
+};
+
+class ShardedMemoryStore : public Cyclone::CacheBackend {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ShardedMemoryStore(const StoreOptions& options) {
+    size_t capacity = parseSize(options, "size_mb", 64) * 1024 * 1024;
+    size_t shards = parseSize(options, "shards",
+                              4 * std::max(1u, std::thread::hardware_concurrency()));
+    shards = std::bit_ceil(std::clamp<size_t>(shards, 1, 1024));
+
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(capacity / shards));
+    }
+    shardMask_ = shards - 1;
+  }
+
+  std::optional<std::string> read(const std::string& key) override {
+    auto hash = hashKey(key);
+    return shardFor(hash).read(key, hash);
+  }
+
+  void write(const std::string& key, std::string value, std::chrono::seconds ttl) override {
+    auto hash = hashKey(key);
+    shardFor(hash).write(key, std::move(value), ttl, hash);
+  }
+
+  bool remove(const std::string& key) override {
+    auto hash = hashKey(key);
+    return shardFor(hash).remove(key);
+  }
+
+  void clear() override {
+    for (auto& shard : shards_) {
+      shard->clear();
+    }
+  }
+
+  size_t shardCount() const { return shards_.size(); }
+
+  std::vector<ShardStats> stats() const {
+    std::vector<ShardStats> result;
+    result.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+      result.push_back(shard->stats());
+    }
+    return result;
+  }
+
+private:
+  enum class Segment { Window, Probation, Protected };
+
+  struct Entry {
+    std::string key;
+    std::string value;
+    uint64_t hash;
+    size_t charge;
+    Clock::time_point expiresAt;  // Clock::time_point::max() when there is no TTL
+    Segment segment;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // List node, index bucket and hash node, charged on top of key and value
+  static constexpr size_t kEntryOverhead =
+    sizeof(Entry) + 2 * sizeof(void*) +
+    sizeof(std::pair<const std::string_view, EntryList::iterator>) + 2 * sizeof(void*);
+
+  class Shard {
+  public:
+    explicit Shard(size_t capacity)
+      : capacity_(capacity),
+        windowCapacity_(std::max<size_t>(capacity / 100, 1)),
+        protectedCapacity_((capacity - windowCapacity_) * 4 / 5),
+        sketch_(capacity / 256) {}
+
+    std::optional<std::string> read(const std::string& key, uint64_t hash) {
+      std::lock_guard lock(mutex_);
+      sketch_.increment(hash);
+
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+      }
+
+      auto entry = it->second;
+      if (entry->expiresAt <= Clock::now()) {
+        ++stats_.expirations;
+        ++stats_.misses;
+        erase(entry);
+        return std::nullopt;
+      }
+
+      ++stats_.hits;
+      touch(entry);
+      return entry->value;
+    }
+
+    void write(const std::string& key, std::string value, std::chrono::seconds ttl, uint64_t hash) {
+      auto expiresAt = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point::max();
+      auto charge = key.size() + value.size() + kEntryOverhead;
+
+      std::lock_guard lock(mutex_);
+      sketch_.increment(hash);
+
+      if (auto it = index_.find(key); it != index_.end()) {
+        erase(it->second);
+      }
+
+      // Could never fit, even in an empty shard
+      if (charge > mainCapacity()) {
+        ++stats_.evictions;
+        return;
+      }
+
+      window_.push_front({key, std::move(value), hash, charge, expiresAt, Segment::Window});
+      index_.emplace(window_.front().key, window_.begin());
+      windowBytes_ += charge;
+
+      while (windowBytes_ > windowCapacity_ && !window_.empty()) {
+        admit(std::prev(window_.end()));
+      }
+    }
+
+    bool remove(const std::string& key) {
+      std::lock_guard lock(mutex_);
+
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        return false;
+      }
+      erase(it->second);
+      return true;
+    }
+
+    void clear() {
+      std::lock_guard lock(mutex_);
+      index_.clear();
+      window_.clear();
+      probation_.clear();
+      protected_.clear();
+      windowBytes_ = probationBytes_ = protectedBytes_ = 0;
+      sketch_.clear();
+    }
+
+    ShardStats stats() const {
+      std::lock_guard lock(mutex_);
+      auto result = stats_;
+      result.entries = index_.size();
+      result.bytes = windowBytes_ + probationBytes_ + protectedBytes_;
+      result.capacity = capacity_;
+      return result;
+    }
+
+  private:
+    size_t mainCapacity() const { return capacity_ - windowCapacity_; }
+    size_t mainBytes() const { return probationBytes_ + protectedBytes_; }
+
+    // Move the window's oldest entry into probation if it beats main's victims
+    void admit(EntryList::iterator candidate) {
+      windowBytes_ -= candidate->charge;
+
+      if (candidate->charge > mainCapacity()) {
+        evict(candidate, window_);
+        return;
+      }
+
+      auto candidateFrequency = sketch_.frequency(candidate->hash);
+      while (mainBytes() + candidate->charge > mainCapacity()) {
+        auto& victims = probation_.empty() ? protected_ : probation_;
+        auto victim = std::prev(victims.end());
+
+        // Ties go to the resident entry: it has already proven itself once
+        if (sketch_.frequency(victim->hash) >= candidateFrequency) {
+          evict(candidate, window_);
+          return;
+        }
+
+        (victim->segment == Segment::Probation ? probationBytes_ : protectedBytes_) -= victim->charge;
+        evict(victim, victims);
+      }
+
+      candidate->segment = Segment::Probation;
+      probation_.splice(probation_.begin(), window_, candidate);
+      probationBytes_ += candidate->charge;
+    }
+
+    void touch(EntryList::iterator entry) {
+      switch (entry->segment) {
+        case Segment::Window:
+          window_.splice(window_.begin(), window_, entry);
+          break;
+
+        case Segment::Probation:
+          probationBytes_ -= entry->charge;
+          protectedBytes_ += entry->charge;
+          entry->segment = Segment::Protected;
+          protected_.splice(protected_.begin(), probation_, entry);
+
+          // Demote the least recently used protected entries back to probation
+          while (protectedBytes_ > protectedCapacity_ && protected_.size() > 1) {
+            auto demoted = std::prev(protected_.end());
+            protectedBytes_ -= demoted->charge;
+            probationBytes_ += demoted->charge;
+            demoted->segment = Segment::Probation;
+            probation_.splice(probation_.begin(), protected_, demoted);
+          }
+          break;
+
+        case Segment::Protected:
+          protected_.splice(protected_.begin(), protected_, entry);
+          break;
+      }
+    }
+
+    void evict(EntryList::iterator entry, EntryList& list) {
+      ++stats_.evictions;
+      index_.erase(entry->key);
+      list.erase(entry);
+    }
+
+    void erase(EntryList::iterator entry) {
+      index_.erase(entry->key);
+      switch (entry->segment) {
+        case Segment::Window:
+          windowBytes_ -= entry->charge;
+          window_.erase(entry);
+          break;
+        case Segment::Probation:
+          probationBytes_ -= entry->charge;
+          probation_.erase(entry);
+          break;
+        case Segment::Protected:
+          protectedBytes_ -= entry->charge;
+          protected_.erase(entry);
+          break;
+      }
+    }
+
+    mutable std::mutex mutex_;
+
+    const size_t capacity_;
+    const size_t windowCapacity_;
+    const size_t protectedCapacity_;
+
+    EntryList window_;
+    EntryList probation_;
+    EntryList protected_;
+    size_t windowBytes_ = 0;
+    size_t probationBytes_ = 0;
+    size_t protectedBytes_ = 0;
+
+    // Keys point into the list entries, whose addresses are stable
+    std::unordered_map<std::string_view, EntryList::iterator> index_;
+    FrequencySketch sketch_;
+    ShardStats stats_;
+  };
+
+  static size_t parseSize(const StoreOptions& options, const std::string& name, size_t fallback) {
+    auto it = options.find(name);
+    if (it == options.end()) {
+      return fallback;
+    }
+    return std::stoul(it->second);
+  }
+
+  static uint64_t hashKey(std::string_view key) {
+    // Spread std::hash so shard selection (high bits) and the sketch (low bits)
+    // see independent-looking values
+    uint64_t h = std::hash<std::string_view>{}(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  Shard& shardFor(uint64_t hash) {
+    return *shards_[(hash >> 40) & shardMask_];
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t shardMask_ = 0;
+};
+
+} // namespace Caching
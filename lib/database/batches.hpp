@@ -0,0 +1,175 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "cyclone/model.hpp"
+#include "projection.hpp"
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Walk a large result set in bounded memory
+ *
+ *   findEach(Like::forPost(id), 1000, [](const Like& like) { ... });
+ *   findInBatches(Post::published(), 500, [](std::vector<Post>& posts) { ... });
+ *
+ * Rows arrive in primary key order, `batchSize` at a time; only the current
+ * batch is held in memory, and the same vector is refilled for each batch.
+ * Returning `false` from the callback stops the walk early.
+ *
+ * On PostgreSQL the query runs once behind a server-side cursor (DECLARE /
+ * FETCH FORWARD) in a transaction, so the walk sees one snapshot and runs on
+ * the primary. Elsewhere, and with `Strategy::Keyset`, each batch is a fresh
+ * `WHERE id > ? ORDER BY id LIMIT n` query: no long transaction and replica
+ * reads, but rows changed mid-walk may or may not be seen. Either way the
+ * query must not carry its own orderBy() or limit().
+ *
+ * Naming a row struct walks plain records instead of models, decoding only
+ * their columns (see record.hpp):
+ *
+ *   findEach<PostRow>(Post::query(), 5000, [](const PostRow& post) { ... });
+ */
+
+namespace Batches {
+
+  enum class Strategy { Auto, Cursor, Keyset };
+
+  namespace detail {
+
+    // Batch callbacks may return void or bool (false stops the walk)
+    template <typename Fn, typename Arg>
+    bool invoke(Fn& fn, Arg& arg) {
+      if constexpr (std::is_same_v<std::invoke_result_t<Fn&, Arg&>, bool>) {
+        return fn(arg);
+      } else {
+        fn(arg);
+        return true;
+      }
+    }
+
+    inline std::string cursorName() {
+      static std::atomic<uint64_t> sequence{0};
+      return "cy_batches_" + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    template <typename Row, typename T>
+    constexpr bool kModelRows = std::is_same_v<Row, T>;
+
+    template <typename Row>
+    int idOf(const Row& row) {
+      if constexpr (requires { row.id(); }) {
+        return row.id();
+      } else {
+        return row.id;
+      }
+    }
+
+    template <typename Row, typename T, typename Fn>
+    void withCursor(Cyclone::QueryBuilder<T> query, size_t batchSize, Fn& fn) {
+      auto ordered = query.orderBy("id", "ASC");
+      if constexpr (!kModelRows<Row, T>) {
+        ordered = ordered.select(Projection::detail::columnsOf<Row>());
+      }
+      auto name = cursorName();
+      auto fetch = "FETCH FORWARD " + std::to_string(batchSize) + " FROM " + name;
+
+      Cyclone::Database::transaction([&]() {
+        Cyclone::Database::execute("DECLARE " + name + " NO SCROLL CURSOR FOR " + ordered.toSql(),
+                                   ordered.bindings());
+
+        std::vector<Row> batch;
+        batch.reserve(batchSize);
+        while (true) {
+          batch.clear();
+          if constexpr (kModelRows<Row, T>) {
+            T::findBySql(fetch, {}, batch);
+          } else {
+            Cyclone::Database::eachRow(fetch, {}, [&](const Cyclone::Database::RowView& row) {
+              Projection::detail::decodeInto(row, batch.emplace_back());
+            });
+          }
+          if (batch.empty() || !invoke(fn, batch) || batch.size() < batchSize) {
+            break;
+          }
+        }
+
+        Cyclone::Database::execute("CLOSE " + name, {});
+      });
+    }
+
+    template <typename Row, typename T, typename Fn>
+    void withKeyset(Cyclone::QueryBuilder<T> query, size_t batchSize, Fn& fn) {
+      std::vector<Row> batch;
+      batch.reserve(batchSize);
+
+      int lastId = 0;
+      bool first = true;
+      while (true) {
+        auto page = first ? query : query.where(T::tableName() + ".id", ">", lastId);
+        first = false;
+
+        batch.clear();
+        auto ordered = page.orderBy("id", "ASC").limit(static_cast<int>(batchSize));
+        if constexpr (kModelRows<Row, T>) {
+          ordered.getInto(batch);
+        } else {
+          selectInto(std::move(ordered), batch);
+        }
+        if (batch.empty()) {
+          break;
+        }
+
+        // Read before the callback, which may move rows out of the batch
+        lastId = idOf(batch.back());
+        if (!invoke(fn, batch) || batch.size() < batchSize) {
+          break;
+        }
+      }
+    }
+
+  } // namespace detail
+
+  struct Options {
+    Strategy strategy = Strategy::Auto;
+  };
+
+} // namespace Batches
+
+// Call `fn(std::vector<Row>&)` for successive batches of at most `batchSize`
+// rows; Row defaults to the query's model
+template <typename Row = void, typename T, typename Fn>
+void findInBatches(Cyclone::QueryBuilder<T> query, size_t batchSize, Fn&& fn, Batches::Options options = {}) {
+  using Batches::Strategy;
+  using Item = std::conditional_t<std::is_void_v<Row>, T, Row>;
+
+  batchSize = batchSize == 0 ? 1000 : batchSize;
+
+  auto strategy = options.strategy;
+  if (strategy == Strategy::Auto) {
+    strategy = Cyclone::Database::adapter() == Cyclone::Database::Adapter::PostgreSQL
+      ? Strategy::Cursor
+      : Strategy::Keyset;
+  }
+
+  if (strategy == Strategy::Cursor) {
+    Batches::detail::withCursor<Item>(std::move(query), batchSize, fn);
+  } else {
+    Batches::detail::withKeyset<Item>(std::move(query), batchSize, fn);
+  }
+}
+
+// Call `fn(Row&)` for every row, loading `batchSize` rows at a time
+template <typename Row = void, typename T, typename Fn>
+void findEach(Cyclone::QueryBuilder<T> query, size_t batchSize, Fn&& fn, Batches::Options options = {}) {
+  using Item = std::conditional_t<std::is_void_v<Row>, T, Row>;
+
+  findInBatches<Item>(std::move(query), batchSize, [&](std::vector<Item>& batch) {
+    for (auto& row : batch) {
+      if (!Batches::detail::invoke(fn, row)) {
+        return false;
+      }
+    }
+    return true;
+  }, options);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "cyclone/model.hpp"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Column projections decoded straight into flat rows
+ *
+ *   auto titles = pluck<int, std::string>(Post::published(), "id", "title");
+ *   for (const auto& [id, title] : titles) { ... }
+ *
+ *   struct AuthorOption {
+ *     int id;
+ *     std::string name;
+ *     static constexpr auto fields() {
+ *       return std::tuple{Projection::field("users.id", &AuthorOption::id),
+ *                         Projection::field("users.name", &AuthorOption::name)};
+ *     }
+ *   };
+ *   auto authors = select<AuthorOption>(User::join<Post>().groupBy("users.id"));
+ *
+ * Only the listed columns are fetched. Each one is decoded by position from
+ * the driver's row into a std::tuple or a plain struct, stored contiguously
+ * in one vector. No model, attribute map or unused column string is built.
+ * Nullable columns decode into std::optional<T>.
+ */
+
+namespace Projection {
+
+  template <typename Struct, typename Member>
+  struct Field {
+    const char* column;
+    Member Struct::* member;
+  };
+
+  template <typename Struct, typename Member>
+  constexpr Field<Struct, Member> field(const char* column, Member Struct::* member) {
+    return {column, member};
+  }
+
+  namespace detail {
+
+    template <typename T>
+    struct IsOptional : std::false_type {};
+
+    template <typename T>
+    struct IsOptional<std::optional<T>> : std::true_type {};
+
+    template <typename T>
+    T decode(const Cyclone::Database::RowView& row, size_t index) {
+      if constexpr (IsOptional<T>::value) {
+        if (row.isNull(index)) {
+          return std::nullopt;
+        }
+        return row.template get<typename T::value_type>(index);
+      } else {
+        return row.template get<T>(index);
+      }
+    }
+
+    inline std::string columnList(std::initializer_list<const char*> columns) {
+      std::string list;
+      for (const char* column : columns) {
+        if (!list.empty()) {
+          list += ", ";
+        }
+        list += column;
+      }
+      return list;
+    }
+
+    // Column list and positional decode for a struct with a static fields()
+    template <typename Struct>
+    std::string columnsOf() {
+      return std::apply([](const auto&... field) {
+        return columnList({field.column...});
+      }, Struct::fields());
+    }
+
+    template <typename Struct>
+    void decodeInto(const Cyclone::Database::RowView& row, Struct& target) {
+      constexpr auto fields = Struct::fields();
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((target.*std::get<I>(fields).member =
+            decode<std::remove_cvref_t<decltype(target.*std::get<I>(fields).member)>>(row, I)), ...);
+      }(std::make_index_sequence<std::tuple_size_v<decltype(fields)>>{});
+    }
+
+    // Run `query` with its projection replaced by `columns`, one callback per row
+    template <typename T, typename Fn>
+    size_t eachRow(Cyclone::QueryBuilder<T> query, const std::string& columns, Fn&& fn) {
+      auto projected = query.select(columns);
+      return Cyclone::Database::eachRow(projected.toSql(), projected.bindings(), std::forward<Fn>(fn));
+    }
+
+  } // namespace detail
+
+} // namespace Projection
+
+// The listed columns of every row, as tuples
+template <typename... Ts, typename T, typename... Columns>
+std::vector<std::tuple<Ts...>> pluck(Cyclone::QueryBuilder<T> query, Columns... columns) {
+  static_assert(sizeof...(Ts) == sizeof...(Columns), "pluck: one type per column");
+
+  std::vector<std::tuple<Ts...>> rows;
+  auto list = Projection::detail::columnList({columns...});
+
+  Projection::detail::eachRow(std::move(query), list, [&](const Cyclone::Database::RowView& row) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      rows.emplace_back(Projection::detail::decode<Ts>(row, I)...);
+    }(std::index_sequence_for<Ts...>{});
+  });
+
+  return rows;
+}
+
+// A single column as a flat vector
+template <typename V, typename T>
+std::vector<V> pluck(Cyclone::QueryBuilder<T> query, const char* column) {
+  std::vector<V> values;
+
+  Projection::detail::eachRow(std::move(query), column, [&](const Cyclone::Database::RowView& row) {
+    values.push_back(Projection::detail::decode<V>(row, 0));
+  });
+
+  return values;
+}
+
+// Append every row of `query`, decoded into `Struct`, to `rows`
+template <typename Struct, typename T>
+void selectInto(Cyclone::QueryBuilder<T> query, std::vector<Struct>& rows) {
+  static_assert(std::is_default_constructible_v<Struct>, "select<Struct>: Struct must be default constructible");
+
+  Projection::detail::eachRow(std::move(query), Projection::detail::columnsOf<Struct>(),
+                              [&](const Cyclone::Database::RowView& row) {
+    Projection::detail::decodeInto(row, rows.emplace_back());
+  });
+}
+
+// Every row decoded into `Struct`, whose static fields() lists column/member pairs
+template <typename Struct, typename T>
+std::vector<Struct> select(Cyclone::QueryBuilder<T> query) {
+  std::vector<Struct> rows;
+  selectInto(std::move(query), rows);
+  return rows;
+}
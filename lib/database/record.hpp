@@ -0,0 +1,185 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "projection.hpp"
+#include <any>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Plain-struct rows with a compile-time schema
+ *
+ * A model's columns described once, as members plus a constexpr field list:
+ *
+ *   struct PostRow : Record<PostRow> {
+ *     static constexpr const char* table = "posts";
+ *     int id = 0;
+ *     std::string title;
+ *     ...
+ *     static constexpr auto fields() {
+ *       return std::tuple{Projection::field("id", &PostRow::id),
+ *                         Projection::field("title", &PostRow::title), ...};
+ *     }
+ *   };
+ *
+ * Every column lives at a fixed offset with its own type, so hydrating is a
+ * positional decode into the members (`PostRow::all(query)`, or
+ * `findEach<PostRow>(...)` for large tables). There is no attribute map.
+ * `set<&PostRow::title>(value)` marks the column in a dirty bitset,
+ * `saveChanges()` writes only the marked columns (plus `updated_at`, when the
+ * record has one), and `toJson()` is unrolled over the field list at compile
+ * time.
+ *
+ * Records skip model validations and callbacks; they are meant for reads and
+ * narrow updates of large result sets, while forms keep using the models.
+ */
+
+template <typename Derived>
+class Record {
+public:
+  static constexpr size_t kMaxFields = 64;
+
+  static constexpr size_t fieldCount() {
+    return std::tuple_size_v<decltype(Derived::fields())>;
+  }
+
+  static constexpr auto columns() {
+    return std::apply([](const auto&... field) {
+      return std::array<const char*, fieldCount()>{field.column...};
+    }, Derived::fields());
+  }
+
+  // Index of `Member` in fields(), resolved at compile time
+  template <auto Member>
+  static constexpr size_t indexOf() {
+    constexpr auto fields = Derived::fields();
+    size_t index = fieldCount();
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      ((matches<Member>(std::get<I>(fields).member) && index == fieldCount() ? (index = I) : 0), ...);
+    }(std::make_index_sequence<fieldCount()>{});
+    return index;
+  }
+
+  template <typename T>
+  static std::vector<Derived> all(Cyclone::QueryBuilder<T> query) {
+    return select<Derived>(std::move(query));
+  }
+
+  static Derived decode(const Cyclone::Database::RowView& row) {
+    Derived record;
+    Projection::detail::decodeInto(row, record);
+    return record;
+  }
+
+  template <auto Member, typename Value>
+  void set(Value&& value) {
+    constexpr auto index = indexOf<Member>();
+    static_assert(index < fieldCount(), "set<>: member is not listed in fields()");
+
+    self().*Member = std::forward<Value>(value);
+    dirty_.set(index);
+  }
+
+  template <auto Member>
+  bool changed() const {
+    return dirty_.test(indexOf<Member>());
+  }
+
+  bool changed() const { return dirty_.any(); }
+
+  void clearChanges() { dirty_.reset(); }
+
+  // UPDATE the changed columns of this row; false when nothing changed
+  bool saveChanges() {
+    if (!dirty_.any()) {
+      return false;
+    }
+
+    // Fragment cache keys include updated_at (views/fragment_cache.hpp), so
+    // any edit must bump it like a model save does
+    if constexpr (requires { &Derived::updated_at; }) {
+      constexpr auto index = indexOf<&Derived::updated_at>();
+      if constexpr (index < fieldCount()) {
+        if (!dirty_.test(index)) {
+          self().updated_at = TimePoint::now();
+          dirty_.set(index);
+        }
+      }
+    }
+
+    std::string sql = std::string("UPDATE ") + Derived::table + " SET ";
+    std::vector<std::any> parameters;
+
+    constexpr auto fields = Derived::fields();
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      ((dirty_.test(I) ? appendAssignment(sql, parameters, std::get<I>(fields)) : void()), ...);
+    }(std::make_index_sequence<fieldCount()>{});
+
+    sql += " WHERE id = ?";
+    parameters.emplace_back(self().id);
+
+    Cyclone::Database::execute(sql, parameters);
+    dirty_.reset();
+    return true;
+  }
+
+  Cyclone::Json toJson() const {
+    Cyclone::Json json = Cyclone::Json::object();
+    std::apply([&](const auto&... field) {
+      ((json[std::string(columnName(field.column))] = jsonValue(self().*field.member)), ...);
+    }, Derived::fields());
+    return json;
+  }
+
+protected:
+  Record() {
+    static_assert(fieldCount() <= kMaxFields, "Record: too many fields for the dirty bitset");
+  }
+
+private:
+  template <auto Member, typename Candidate>
+  static constexpr bool matches(Candidate candidate) {
+    if constexpr (std::is_same_v<Candidate, decltype(Member)>) {
+      return candidate == Member;
+    } else {
+      return false;
+    }
+  }
+
+  template <typename Field>
+  void appendAssignment(std::string& sql, std::vector<std::any>& parameters, const Field& field) const {
+    if (!parameters.empty()) {
+      sql += ", ";
+    }
+    sql += std::string(columnName(field.column)) + " = ?";
+    parameters.emplace_back(self().*field.member);
+  }
+
+  // "posts.title" -> "title"
+  static constexpr std::string_view columnName(std::string_view column) {
+    auto dot = column.rfind('.');
+    return dot == std::string_view::npos ? column : column.substr(dot + 1);
+  }
+
+  template <typename T>
+  static Cyclone::Json jsonValue(const T& value) {
+    if constexpr (Projection::detail::IsOptional<T>::value) {
+      return value ? Cyclone::Json(*value) : Cyclone::Json(nullptr);
+    } else {
+      return Cyclone::Json(value);
+    }
+  }
+
+  const Derived& self() const { return static_cast<const Derived&>(*this); }
+  Derived& self() { return static_cast<Derived&>(*this); }
+
+  std::bitset<kMaxFields> dirty_;
+};
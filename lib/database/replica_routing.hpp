@@ -0,0 +1,208 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+namespace Replicas {
+
+/**
+ * Read/write splitting between the primary and the `replica` connection
+ *
+ * Once installed, every statement the models execute is routed by select():
+ *
+ *   - writes, and anything inside a transaction, go to the primary;
+ *   - after the first write in a request, the rest of that request reads from
+ *     the primary too ("read your writes"), and ReplicaRoutingMiddleware keeps
+ *     the next requests on the primary for `stickiness` so a redirect after a
+ *     POST does not read a lagging replica;
+ *   - other reads go to the replica while its measured lag is under `maxLag`,
+ *     and fall back to the primary when it is behind or unreachable.
+ *
+ * Explicit overrides wrap a block, like Database::transaction():
+ *
+ *   auto stats = Replicas::onReplica([&] { return Post::count(); });
+ *   auto post  = Replicas::onPrimary([&] { return Post::find(id); });
+ *
+ * Routing state is per request and therefore thread-local; without a
+ * Scope (jobs, tasks, background threads) writes do not pin later reads,
+ * and only the lag check applies.
+ */
+
+struct Options {
+  std::string replica = "replica";
+  std::chrono::milliseconds maxLag{2000};
+  std::chrono::milliseconds stickiness{2000};   // Primary reads after a write, across requests
+  std::chrono::milliseconds lagProbeInterval{1000};
+};
+
+enum class Target { Auto, Primary, Replica };
+
+namespace detail {
+
+  inline int64_t nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  struct RequestState {
+    bool scoped = false;  // Inside a Scope; only then do writes pin reads
+    bool pinned = false;  // A recent earlier request wrote
+    bool wrote = false;
+    Target target = Target::Auto;
+  };
+
+  inline RequestState& state() {
+    thread_local RequestState current;
+    return current;
+  }
+
+  struct Config {
+    bool installed = false;
+    Options options;
+  };
+
+  inline Config& config() {
+    static Config instance;
+    return instance;
+  }
+
+} // namespace detail
+
+// Replica lag, probed at most once per lagProbeInterval across all threads
+class LagMonitor {
+public:
+  static bool healthy() {
+    const auto& options = detail::config().options;
+    auto now = detail::nowMillis();
+
+    auto checked = lastProbe().load(std::memory_order_relaxed);
+    if (now - checked >= options.lagProbeInterval.count() &&
+        lastProbe().compare_exchange_strong(checked, now)) {
+      lag().store(probe(options.replica), std::memory_order_relaxed);
+    }
+
+    return lag().load(std::memory_order_relaxed) <= options.maxLag.count();
+  }
+
+  static int64_t lagMillis() {
+    return lag().load(std::memory_order_relaxed);
+  }
+
+private:
+  // Zero when the replica has replayed everything it received, so an idle
+  // primary does not read as lag
+  static int64_t probe(const std::string& replica) {
+    try {
+      auto lag = Cyclone::Database::connection(replica).scalar<double>(
+        "SELECT CASE WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 "
+        "ELSE COALESCE(EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000, 0) END"
+      );
+      return static_cast<int64_t>(lag);
+    } catch (const std::exception& e) {
+      Logger::error("Replica lag probe failed, reading from primary: {}", e.what());
+      return std::numeric_limits<int64_t>::max();
+    }
+  }
+
+  static std::atomic<int64_t>& lastProbe() {
+    static std::atomic<int64_t> value{std::numeric_limits<int64_t>::min() / 2};
+    return value;
+  }
+
+  static std::atomic<int64_t>& lag() {
+    static std::atomic<int64_t> value{0};
+    return value;
+  }
+};
+
+// Connection name for one statement; installed as the database's connection selector
+inline std::string_view select(const Cyclone::Database::QueryContext& query) {
+  static const std::string primary = "default";
+  auto& request = detail::state();
+  const auto& options = detail::config().options;
+
+  if (!query.readOnly) {
+    // Outside a request (Pulse workers, relay and flush threads) a write
+    // must not pin the thread's reads to the primary for good
+    if (request.scoped) {
+      request.wrote = true;
+    }
+    return primary;
+  }
+  if (query.inTransaction || request.target == Target::Primary) {
+    return primary;
+  }
+
+  // An explicit onReplica() skips the read-your-writes pin, but not the lag check
+  if (request.target == Target::Auto && (request.pinned || request.wrote)) {
+    return primary;
+  }
+
+  return LagMonitor::healthy() ? std::string_view(options.replica) : std::string_view(primary);
+}
+
+inline void install(Options options) {
+  auto& config = detail::config();
+  config.options = std::move(options);
+  config.installed = true;
+
+  Cyclone::Database::setConnectionSelector(&select);
+}
+
+inline bool installed() {
+  return detail::config().installed;
+}
+
+// Per-request routing state, opened by ReplicaRoutingMiddleware
+class Scope {
+public:
+  // `pinned` when a recent write (possibly in an earlier request) requires
+  // reading from the primary
+  explicit Scope(bool pinned) : previous_(detail::state()) {
+    detail::state() = {.scoped = true, .pinned = pinned};
+  }
+
+  ~Scope() { detail::state() = previous_; }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+  // Whether this request wrote to the primary
+  bool wrote() const { return detail::state().wrote; }
+
+private:
+  detail::RequestState previous_;
+};
+
+template <typename Fn>
+decltype(auto) on(Target target, Fn&& fn) {
+  auto& request = detail::state();
+  auto previous = std::exchange(request.target, target);
+
+  struct Restore {
+    Target& target;
+    Target previous;
+    ~Restore() { target = previous; }
+  } restore{request.target, previous};
+
+  return std::forward<Fn>(fn)();
+}
+
+// Read from the replica even after a write in this request (lag permitting)
+template <typename Fn>
+decltype(auto) onReplica(Fn&& fn) {
+  return on(Target::Replica, std::forward<Fn>(fn));
+}
+
+// Always read from the primary inside `fn`
+template <typename Fn>
+decltype(auto) onPrimary(Fn&& fn) {
+  return on(Target::Primary, std::forward<Fn>(fn));
+}
+
+} // namespace Replicas
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "cyclone/crypto.hpp"
+#include "cyclone/database.hpp"
+#include "cyclone/model.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Keyset ("seek") pagination, newest first
+ *
+ *   auto page = seekPaginate(Post::published(), params.get<std::string>("cursor", ""), 20);
+ *   page.items        // at most 20 posts
+ *   page.pagination   // cursors for the previous / next page
+ *
+ * Instead of `OFFSET n`, each page continues from the `(created_at, id)` of
+ * the row at its edge:
+ *
+ *   WHERE (created_at, id) < (?, ?) ORDER BY created_at DESC, id DESC LIMIT 21
+ *
+ * which is an index range scan whatever the depth, and one extra row tells
+ * whether another page follows, so no COUNT(*) is needed. Cursors are opaque,
+ * HMAC-signed tokens; a tampered or foreign cursor restarts at the first page.
+ * `estimateTotal` asks the planner for its row estimate (PostgreSQL only)
+ * instead of counting.
+ */
+
+struct SeekPagination {
+  std::string next_cursor;   // Empty on the last page
+  std::string prev_cursor;   // Empty on the first page
+  std::optional<int64_t> estimated_total;
+
+  bool has_next() const { return !next_cursor.empty(); }
+  bool has_prev() const { return !prev_cursor.empty(); }
+
+  // False when everything fits on one page, so views can skip the controls
+  explicit operator bool() const { return has_next() || has_prev(); }
+};
+
+template <typename T>
+struct SeekPage {
+  std::vector<T> items;
+  SeekPagination pagination;
+};
+
+struct SeekOptions {
+  bool estimateTotal = false;
+};
+
+namespace SeekCursor {
+
+  enum class Direction : char { After = 'a', Before = 'b' };
+
+  struct Position {
+    Direction direction;
+    int64_t createdAtMicros;
+    int id;
+  };
+
+  inline std::string& secret() {
+    static std::string value;
+    return value;
+  }
+
+  // Call once at boot; cursors are signed with this key
+  inline void configure(std::string key) {
+    secret() = std::move(key);
+  }
+
+  inline std::string encode(const Position& position) {
+    std::string payload;
+    payload += static_cast<char>(position.direction);
+    payload += ':';
+    payload += std::to_string(position.createdAtMicros);
+    payload += ':';
+    payload += std::to_string(position.id);
+
+    auto body = Cyclone::Crypto::base64UrlEncode(payload);
+    auto signature = Cyclone::Crypto::hmacSha256(secret(), body).substr(0, 12);
+    return body + "." + Cyclone::Crypto::base64UrlEncode(signature);
+  }
+
+  inline std::optional<Position> decode(std::string_view token) {
+    auto dot = token.find('.');
+    if (token.empty() || dot == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    auto body = token.substr(0, dot);
+    auto signature = Cyclone::Crypto::base64UrlDecode(token.substr(dot + 1));
+    if (!signature ||
+        !Cyclone::Crypto::secureCompare(*signature, Cyclone::Crypto::hmacSha256(secret(), body).substr(0, 12))) {
+      return std::nullopt;
+    }
+
+    auto payload = Cyclone::Crypto::base64UrlDecode(body);
+    if (!payload || payload->size() < 5 || (*payload)[1] != ':') {
+      return std::nullopt;
+    }
+
+    Position position{static_cast<Direction>((*payload)[0]), 0, 0};
+    if (position.direction != Direction::After && position.direction != Direction::Before) {
+      return std::nullopt;
+    }
+
+    std::string_view rest = std::string_view(*payload).substr(2);
+    auto separator = rest.find(':');
+    if (separator == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto [timeEnd, timeError] = std::from_chars(rest.data(), rest.data() + separator, position.createdAtMicros);
+    auto [idEnd, idError] = std::from_chars(rest.data() + separator + 1, rest.data() + rest.size(), position.id);
+    if (timeError != std::errc() || idError != std::errc()) {
+      return std::nullopt;
+    }
+    return position;
+  }
+
+  template <typename T>
+  Position at(const T& row, Direction direction) {
+    auto createdAt = row.template get<TimePoint>("created_at");
+    return {
+      direction,
+      std::chrono::duration_cast<std::chrono::microseconds>(createdAt.time_since_epoch()).count(),
+      row.id()
+    };
+  }
+
+} // namespace SeekCursor
+
+// The planner's row estimate for `query`, or nullopt where the adapter has none
+template <typename T>
+std::optional<int64_t> estimatedCount(const Cyclone::QueryBuilder<T>& query) {
+  if (Cyclone::Database::adapter() != Cyclone::Database::Adapter::PostgreSQL) {
+    return std::nullopt;
+  }
+
+  auto plan = Cyclone::Database::scalar<std::string>(
+    "EXPLAIN (FORMAT JSON) " + query.toSql(), query.bindings());
+
+  static constexpr std::string_view kRows = "\"Plan Rows\": ";
+  auto at = plan.find(kRows);
+  if (at == std::string::npos) {
+    return std::nullopt;
+  }
+
+  int64_t rows = 0;
+  auto begin = plan.data() + at + kRows.size();
+  std::from_chars(begin, plan.data() + plan.size(), rows);
+  return rows;
+}
+
+template <typename T>
+SeekPage<T> seekPaginate(Cyclone::QueryBuilder<T> query, std::string_view cursor, int perPage,
+                         SeekOptions options = {}) {
+  using SeekCursor::Direction;
+
+  perPage = std::clamp(perPage, 1, 100);
+
+  SeekPage<T> page;
+  if (options.estimateTotal) {
+    page.pagination.estimated_total = estimatedCount(query);
+  }
+
+  auto position = SeekCursor::decode(cursor);
+  bool backwards = position && position->direction == Direction::Before;
+
+  if (position) {
+    auto createdAt = TimePoint(std::chrono::duration_cast<TimePoint::duration>(
+      std::chrono::microseconds(position->createdAtMicros)));
+    query = query.whereRaw(backwards ? "(created_at, id) > (?, ?)" : "(created_at, id) < (?, ?)",
+                           {createdAt, position->id});
+  }
+
+  const char* order = backwards ? "ASC" : "DESC";
+  auto rows = query.orderBy("created_at", order).orderBy("id", order).limit(perPage + 1).get();
+
+  bool more = static_cast<int>(rows.size()) > perPage;
+  if (more) {
+    rows.pop_back();
+  }
+  if (backwards) {
+    std::reverse(rows.begin(), rows.end());
+  }
+
+  if (!rows.empty()) {
+    // Going forward, `more` means a next page; going back, a previous one.
+    // The side we came from always exists.
+    bool hasNext = backwards || more;
+    bool hasPrev = backwards ? more : position.has_value();
+
+    if (hasNext) {
+      page.pagination.next_cursor = SeekCursor::encode(SeekCursor::at(rows.back(), Direction::After));
+    }
+    if (hasPrev) {
+      page.pagination.prev_cursor = SeekCursor::encode(SeekCursor::at(rows.front(), Direction::Before));
+    }
+  }
+
+  page.items = std::move(rows);
+  return page;
+}
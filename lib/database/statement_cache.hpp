@@ -0,0 +1,358 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <sqlite3.h>
+#if __has_include(<libpq-fe.h>)
+#include <libpq-fe.h>
+#define CYCLONE_STATEMENTS_POSTGRESQL 1
+#endif
+
+namespace Statements {
+
+/**
+ * Per-connection prepared statement cache
+ *
+ * QueryBuilder<T> emits a handful of SQL shapes (`SELECT ... WHERE id = ?
+ * LIMIT 1`, `... WHERE likeable_id = ? AND user_id = ?`, ...) with values
+ * bound as parameters. Each pooled connection keeps an LRU of statements keyed
+ * on the normalized SQL, so repeating a shape skips parse and plan and only
+ * binds new values. The normalized SQL is only the key: every statement is
+ * prepared from the SQL exactly as the caller wrote it.
+ *
+ *   defaultConfig.statement_provider = Statements::perConnectionLru({.capacity = 256});
+ *
+ * A connection is only used by one thread at a time, so the LRU itself is not
+ * locked. Hit/miss counters are process-wide (see stats()).
+ */
+
+struct Options {
+  size_t capacity = 256;  // Statements kept per connection
+};
+
+struct Stats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  uint64_t bypasses = 0;  // Statement busy (nested cursor), prepared uncached
+
+  double hitRate() const {
+    auto lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+  }
+};
+
+namespace detail {
+
+  struct Counters {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> bypasses{0};
+  };
+
+  inline Counters& counters() {
+    static Counters instance;
+    return instance;
+  }
+
+  inline void count(std::atomic<uint64_t>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Comments, backslash escapes and dollar quoting change where literals end
+  // depending on dialect and settings, so whitespace next to them is not
+  // safely collapsible
+  inline bool hasDialectSyntax(std::string_view sql) {
+    if (sql.find("--") != std::string_view::npos || sql.find("/*") != std::string_view::npos ||
+        sql.find('\\') != std::string_view::npos) {
+      return true;
+    }
+    for (auto dollar = sql.find('$'); dollar != std::string_view::npos; dollar = sql.find('$', dollar + 1)) {
+      if (dollar + 1 == sql.size() || sql[dollar + 1] < '0' || sql[dollar + 1] > '9') {
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace detail
+
+inline Stats stats() {
+  auto& counters = detail::counters();
+  return {
+    counters.hits.load(std::memory_order_relaxed),
+    counters.misses.load(std::memory_order_relaxed),
+    counters.evictions.load(std::memory_order_relaxed),
+    counters.bypasses.load(std::memory_order_relaxed)
+  };
+}
+
+// Cache key for `sql`: whitespace runs outside string literals collapsed and
+// trimmed, so that formatting differences between call sites share one
+// statement. SQL with comments, backslashes or dollar quoting is keyed as
+// written, so two different statements can never share a key.
+inline std::string normalize(std::string_view sql) {
+  if (detail::hasDialectSyntax(sql)) {
+    return std::string(sql);
+  }
+
+  std::string normalized;
+  normalized.reserve(sql.size());
+
+  char quote = 0;
+  bool pendingSpace = false;
+  for (char c : sql) {
+    if (quote) {
+      normalized += c;
+      if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      pendingSpace = !normalized.empty();
+      continue;
+    }
+
+    if (pendingSpace) {
+      normalized += ' ';
+      pendingSpace = false;
+    }
+    if (c == '\'' || c == '"' || c == '`') {
+      quote = c;
+    } else if (c == '[') {
+      quote = ']';  // SQLite bracket-quoted identifier
+    }
+    normalized += c;
+  }
+
+  return normalized;
+}
+
+// LRU of prepared handles; `finalize` releases a handle on eviction
+template <typename Handle>
+class Lru {
+public:
+  // A capacity of 0 is treated as 1: insert() must keep the entry it returns
+  Lru(size_t capacity, std::function<void(Handle&)> finalize)
+    : capacity_(std::max<size_t>(capacity, 1)), finalize_(std::move(finalize)) {}
+
+  ~Lru() { clear(); }
+
+  Lru(const Lru&) = delete;
+  Lru& operator=(const Lru&) = delete;
+
+  Handle* find(const std::string& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->second;
+  }
+
+  Handle& insert(const std::string& key, Handle handle) {
+    entries_.emplace_front(key, std::move(handle));
+    index_[entries_.front().first] = entries_.begin();
+
+    while (entries_.size() > capacity_) {
+      auto& oldest = entries_.back();
+      finalize_(oldest.second);
+      index_.erase(oldest.first);
+      entries_.pop_back();
+      detail::count(detail::counters().evictions);
+    }
+
+    return entries_.front().second;
+  }
+
+  void clear() {
+    for (auto& entry : entries_) {
+      finalize_(entry.second);
+    }
+    index_.clear();
+    entries_.clear();
+  }
+
+private:
+  using Entries = std::list<std::pair<std::string, Handle>>;
+
+  size_t capacity_;
+  std::function<void(Handle&)> finalize_;
+  Entries entries_;
+  std::unordered_map<std::string_view, typename Entries::iterator> index_;
+};
+
+// SQLite: statements are compiled once with SQLITE_PREPARE_PERSISTENT and
+// reset between uses. A statement whose cursor is still open (a query run
+// while iterating the results of the same shape) is bypassed rather than
+// reset underneath its reader.
+class SqliteStatementCache : public Cyclone::Database::SQLite::StatementProvider {
+public:
+  SqliteStatementCache(sqlite3* db, Options options)
+    : db_(db), statements_(options.capacity, [this](sqlite3_stmt*& statement) { evicted(statement); }) {}
+
+  ~SqliteStatementCache() override {
+    closing_ = true;
+    statements_.clear();
+  }
+
+  sqlite3_stmt* prepare(std::string_view sql) override {
+    auto key = normalize(sql);
+
+    if (auto* cached = statements_.find(key)) {
+      auto& state = states_[*cached];
+      if (state.busy) {
+        detail::count(detail::counters().bypasses);
+        return compile(sql, /* persistent */ false);
+      }
+
+      detail::count(detail::counters().hits);
+      sqlite3_reset(*cached);
+      sqlite3_clear_bindings(*cached);
+      state.busy = true;
+      return *cached;
+    }
+
+    detail::count(detail::counters().misses);
+    auto* statement = compile(sql, /* persistent */ true);
+    states_[statement] = {.busy = true, .cached = true};
+    statements_.insert(key, statement);
+    return statement;
+  }
+
+  // Called when the caller is done stepping the statement
+  void release(sqlite3_stmt* statement) override {
+    auto it = states_.find(statement);
+    if (it == states_.end()) {
+      sqlite3_finalize(statement);  // One-off bypass statement
+      return;
+    }
+
+    if (!it->second.cached) {
+      states_.erase(it);           // Evicted while its cursor was open
+      sqlite3_finalize(statement);
+      return;
+    }
+
+    sqlite3_reset(statement);
+    it->second.busy = false;
+  }
+
+private:
+  struct State {
+    bool busy = false;
+    bool cached = false;
+  };
+
+  // Never finalize a statement out from under an open cursor
+  void evicted(sqlite3_stmt* statement) {
+    auto it = states_.find(statement);
+    if (it != states_.end() && it->second.busy && !closing_) {
+      it->second.cached = false;
+      return;
+    }
+
+    if (it != states_.end()) {
+      states_.erase(it);
+    }
+    sqlite3_finalize(statement);
+  }
+
+  sqlite3_stmt* compile(std::string_view sql, bool persistent) {
+    sqlite3_stmt* statement = nullptr;
+    auto flags = persistent ? SQLITE_PREPARE_PERSISTENT : 0;
+    if (sqlite3_prepare_v3(db_, sql.data(), static_cast<int>(sql.size()), flags, &statement, nullptr) != SQLITE_OK) {
+      throw Cyclone::Database::Error(sqlite3_errmsg(db_));
+    }
+    return statement;
+  }
+
+  sqlite3* db_;
+  bool closing_ = false;
+  std::unordered_map<sqlite3_stmt*, State> states_;  // Declared before the LRU, which uses it on destruction
+  Lru<sqlite3_stmt*> statements_;
+};
+
+#ifdef CYCLONE_STATEMENTS_POSTGRESQL
+
+// PostgreSQL: each shape becomes a named server-side statement executed with
+// PQexecPrepared. Results are fully fetched per execution, so a statement is
+// never busy. Evicted names are DEALLOCATEd.
+class PostgresStatementCache : public Cyclone::Database::PostgreSQL::StatementProvider {
+public:
+  PostgresStatementCache(PGconn* connection, Options options)
+    : connection_(connection),
+      statements_(options.capacity, [this](std::string& name) { deallocate(name); }) {}
+
+  std::string prepare(std::string_view sql, int parameterCount) override {
+    auto key = normalize(sql);
+
+    if (auto* name = statements_.find(key)) {
+      detail::count(detail::counters().hits);
+      return *name;
+    }
+
+    detail::count(detail::counters().misses);
+    auto name = "cy_" + std::to_string(++sequence_);
+    std::string text(sql);
+    std::unique_ptr<PGresult, void (*)(PGresult*)> result(
+      PQprepare(connection_, name.c_str(), text.c_str(), parameterCount, nullptr), PQclear);
+
+    if (PQresultStatus(result.get()) != PGRES_COMMAND_OK) {
+      throw Cyclone::Database::Error(PQerrorMessage(connection_));
+    }
+
+    return statements_.insert(key, std::move(name));
+  }
+
+  // The server forgets prepared statements when the session is reset
+  void connectionReset() override {
+    statements_.clear();
+  }
+
+private:
+  void deallocate(const std::string& name) {
+    if (PQstatus(connection_) == CONNECTION_OK) {
+      PQclear(PQexec(connection_, ("DEALLOCATE " + name).c_str()));
+    }
+  }
+
+  PGconn* connection_;
+  uint64_t sequence_ = 0;
+  Lru<std::string> statements_;
+};
+
+#endif
+
+// Factory for Configuration::statement_provider: one cache per pooled
+// connection, matching the connection's adapter
+inline auto perConnectionLru(Options options) {
+  return [options](Cyclone::Database::Connection& connection)
+      -> std::unique_ptr<Cyclone::Database::StatementProviderBase> {
+    switch (connection.adapter()) {
+      case Cyclone::Database::Adapter::SQLite:
+        return std::make_unique<SqliteStatementCache>(connection.nativeHandle<sqlite3>(), options);
+#ifdef CYCLONE_STATEMENTS_POSTGRESQL
+      case Cyclone::Database::Adapter::PostgreSQL:
+        return std::make_unique<PostgresStatementCache>(connection.nativeHandle<PGconn>(), options);
+#endif
+      default:
+        return nullptr;  // Adapter prepares per query as before
+    }
+  };
+}
+
+} // namespace Statements
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Jobs {
+
+/**
+ * Compact binary archive for job Params
+ *
+ * Works with the existing `serialize(Archive&)` contract, so a Params struct
+ * needs no changes:
+ *
+ *   auto bytes = Jobs::encode(params);                       // std::string
+ *   auto copy = Jobs::decode<NotificationJob::Params>(bytes);
+ *
+ * Layout: one version byte, then one field per `ar & member`, in order:
+ *
+ *   key    varint   (tag << 3) | wire type; tags count from 1 in serialize() order
+ *   value  varint   integers, bools and enums (signed ones zigzag-encoded)
+ *          bytes    varint length + raw bytes, for strings
+ *
+ * A NotificationJob is about 20 bytes. Tags let the schema evolve:
+ *   - new fields go at the end of serialize();
+ *   - an older reader skips tags it does not know;
+ *   - a newer reader leaves fields missing from an older payload at their
+ *     defaults.
+ * Fields must not be reordered or removed; keep reading a retired field into
+ * a local instead.
+ *
+ * Decoding reads straight from the payload buffer into the Params members.
+ * There is no intermediate document, and a std::string_view member points
+ * into the buffer without copying.
+ */
+
+constexpr uint8_t kArchiveVersion = 1;
+
+namespace detail {
+
+  enum class WireType : uint8_t { Varint = 0, Bytes = 2 };
+
+  template <typename T>
+  constexpr bool kStringLike = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+} // namespace detail
+
+class BinaryWriter {
+public:
+  explicit BinaryWriter(std::string& out) : out_(out) {
+    out_.push_back(static_cast<char>(kArchiveVersion));
+  }
+
+  template <typename T>
+  BinaryWriter& operator&(const T& value) {
+    if constexpr (std::is_enum_v<T>) {
+      return *this & static_cast<std::underlying_type_t<T>>(value);
+    } else {
+      ++tag_;
+      if constexpr (detail::kStringLike<T>) {
+        key(detail::WireType::Bytes);
+        varint(value.size());
+        out_.append(value.data(), value.size());
+      } else {
+        static_assert(std::is_integral_v<T>, "BinaryWriter: fields must be integers, bools, enums or strings");
+        key(detail::WireType::Varint);
+        if constexpr (std::is_signed_v<T>) {
+          auto wide = static_cast<int64_t>(value);
+          varint((static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+        } else {
+          varint(static_cast<uint64_t>(value));
+        }
+      }
+      return *this;
+    }
+  }
+
+private:
+  void key(detail::WireType type) {
+    varint((static_cast<uint64_t>(tag_) << 3) | static_cast<uint64_t>(type));
+  }
+
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out_.push_back(static_cast<char>(value));
+  }
+
+  std::string& out_;
+  uint32_t tag_ = 0;
+};
+
+class BinaryReader {
+public:
+  explicit BinaryReader(std::string_view in) : in_(in) {
+    if (in_.empty() || static_cast<uint8_t>(in_[0]) != kArchiveVersion) {
+      throw std::runtime_error("BinaryReader: unsupported archive version");
+    }
+    in_.remove_prefix(1);
+  }
+
+  template <typename T>
+  BinaryReader& operator&(T& value) {
+    if constexpr (std::is_enum_v<T>) {
+      auto raw = static_cast<std::underlying_type_t<T>>(value);
+      *this & raw;
+      value = static_cast<T>(raw);
+      return *this;
+    } else {
+      ++tag_;
+      if (!seek()) {
+        return *this;   // Not in this payload: keep the default
+      }
+
+      if constexpr (detail::kStringLike<T>) {
+        expect(detail::WireType::Bytes);
+        auto bytes = take(varint());
+        value = T(bytes);
+      } else {
+        static_assert(std::is_integral_v<T>, "BinaryReader: fields must be integers, bools, enums or strings");
+        expect(detail::WireType::Varint);
+        auto raw = varint();
+        if constexpr (std::is_same_v<T, bool>) {
+          value = raw != 0;
+        } else if constexpr (std::is_signed_v<T>) {
+          value = static_cast<T>(static_cast<int64_t>((raw >> 1) ^ (~(raw & 1) + 1)));
+        } else {
+          value = static_cast<T>(raw);
+        }
+      }
+      pending_ = false;
+      return *this;
+    }
+  }
+
+private:
+  // Position on the field for tag_, skipping fields this reader does not
+  // know; false when the payload has no such field
+  bool seek() {
+    while (true) {
+      if (!pending_) {
+        if (in_.empty()) {
+          return false;
+        }
+        auto key = varint();
+        pendingTag_ = static_cast<uint32_t>(key >> 3);
+        pendingType_ = static_cast<detail::WireType>(key & 0x7);
+        pending_ = true;
+      }
+
+      if (pendingTag_ == tag_) {
+        return true;
+      }
+      if (pendingTag_ > tag_) {
+        return false;
+      }
+      skip();
+    }
+  }
+
+  void skip() {
+    if (pendingType_ == detail::WireType::Varint) {
+      varint();
+    } else if (pendingType_ == detail::WireType::Bytes) {
+      take(varint());
+    } else {
+      throw std::runtime_error("BinaryReader: unknown wire type");
+    }
+    pending_ = false;
+  }
+
+  void expect(detail::WireType type) const {
+    if (pendingType_ != type) {
+      throw std::runtime_error("BinaryReader: field type changed");
+    }
+  }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (in_.empty()) {
+        break;
+      }
+      auto byte = static_cast<uint8_t>(in_[0]);
+      in_.remove_prefix(1);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (byte < 0x80) {
+        return value;
+      }
+    }
+    throw std::runtime_error("BinaryReader: truncated varint");
+  }
+
+  std::string_view take(uint64_t length) {
+    if (length > in_.size()) {
+      throw std::runtime_error("BinaryReader: truncated field");
+    }
+    auto bytes = in_.substr(0, static_cast<size_t>(length));
+    in_.remove_prefix(static_cast<size_t>(length));
+    return bytes;
+  }
+
+  std::string_view in_;
+  uint32_t tag_ = 0;
+  bool pending_ = false;
+  uint32_t pendingTag_ = 0;
+  detail::WireType pendingType_ = detail::WireType::Varint;
+};
+
+template <typename Params>
+std::string encode(Params params) {
+  std::string out;
+  BinaryWriter writer(out);
+  params.serialize(writer);
+  return out;
+}
+
+// `bytes` must outlive any std::string_view member of the result
+template <typename Params>
+Params decode(std::string_view bytes) {
+  Params params{};
+  BinaryReader reader(bytes);
+  params.serialize(reader);
+  return params;
+}
+
+struct SerializeBench {
+  size_t bytes = 0;
+  double encodeNs = 0;
+  double decodeNs = 0;
+};
+
+// Average encode and decode time of `params` over `iterations` runs
+template <typename Params>
+SerializeBench benchSerialize(const Params& params, size_t iterations) {
+  using Clock = std::chrono::steady_clock;
+  SerializeBench result;
+
+  std::string buffer;
+  auto start = Clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    buffer.clear();
+    BinaryWriter writer(buffer);
+    auto copy = params;
+    copy.serialize(writer);
+  }
+  result.encodeNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+  result.bytes = buffer.size();
+
+  // Keep the optimizer from dropping the decodes
+  volatile size_t sink = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    auto decoded = decode<Params>(buffer);
+    sink = sink + *reinterpret_cast<const unsigned char*>(&decoded);
+  }
+  result.decodeNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+  (void)sink;
+
+  return result;
+}
+
+} // namespace Jobs
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "cyclone/job.hpp"
+#include "outbox.hpp"
+#include <chrono>
+#include <span>
+
+namespace Jobs {
+
+/**
+ * Enqueue a list of jobs in one backend round trip
+ *
+ *   std::vector<NotificationJob::Params> params = ...;
+ *   Jobs::enqueueMany<NotificationJob>(params);
+ *   Jobs::enqueueMany<NotificationJob>(digests, std::chrono::minutes(5));   // delayed
+ *
+ * The enqueues are issued inside JobQueue::pipeline(), which writes the whole
+ * list to the job store at once (one transaction, or one pipelined command
+ * batch), instead of one write per job. Inside a database transaction the
+ * list goes to the job outbox instead, and commits with it (see outbox.hpp).
+ */
+
+template <typename Job>
+void enqueueMany(std::span<const typename Job::Params> params,
+                 std::chrono::seconds delay = std::chrono::seconds(0)) {
+  auto enqueue = [&](const typename Job::Params& item) {
+    if (delay.count() > 0) {
+      JobQueue::enqueueIn<Job>(delay, item);
+    } else {
+      JobQueue::enqueue<Job>(item);
+    }
+  };
+
+  if (params.empty()) {
+    return;
+  }
+  if (Cyclone::Database::inTransaction()) {
+    Outbox::write<Job>(params, delay);
+    return;
+  }
+  if (params.size() == 1) {
+    enqueue(params.front());
+    return;
+  }
+
+  JobQueue::pipeline([&]() {
+    for (const auto& item : params) {
+      enqueue(item);
+    }
+  });
+}
+
+} // namespace Jobs
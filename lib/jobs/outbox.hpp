@@ -0,0 +1,320 @@
+#pragma once
+
+#include "cyclone/database.hpp"
+#include "cyclone/job.hpp"
+#include "binary_archive.hpp"
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Jobs {
+
+/**
+ * Transactional outbox for jobs
+ *
+ * A job enqueued while a database transaction is open (Jobs::enqueueMany,
+ * NotificationJob::notify) is written to the job_outbox table instead of
+ * going to Pulse. It commits or rolls back with the rows that caused it:
+ *
+ *   Cyclone::Database::transaction([&]() {
+ *     if (comment.save()) {
+ *       NotificationJob::notifyAll(notifications);   // rows in job_outbox
+ *     }
+ *   });
+ *
+ * So a crash after the commit cannot lose the jobs, and a rolled-back request
+ * cannot send them. The request pays one multi-row INSERT, in a transaction it
+ * already has, instead of a job store round trip.
+ *
+ * The relay thread (Outbox::start) takes the oldest rows in batches and hands
+ * each batch to Pulse with one JobQueue::pipeline(). It deletes them in the
+ * same transaction. On PostgreSQL, rows are claimed with FOR UPDATE SKIP
+ * LOCKED, so several processes can relay at once. When Pulse keeps its jobs
+ * in this database, the pipeline joins that transaction and the hand-off
+ * happens exactly once. With a separate job store, a crash between the
+ * pipeline and the commit hands the batch over again.
+ *
+ * Params are stored in the `params` column with their serialize(), using the
+ * binary archive (binary_archive.hpp), and decoded in place from the fetched
+ * bytes.
+ *
+ * Each job type names itself in the `job` column with an explicit, stable
+ * `static constexpr const char* kOutboxName` (not its C++ type name, which
+ * a rename or another compiler would change under rows already written).
+ * A type is known to the relay once the program enqueues it anywhere, and
+ * the relay only claims rows of known types, so rows meant for another
+ * deployment never hold up the queue. A row whose params cannot be decoded
+ * is logged and deleted. jobTypes() lists the known types for
+ * bin/cy pulse:bench-serialize.
+ */
+
+class Outbox {
+public:
+  struct Options {
+    std::chrono::milliseconds pollInterval{200};
+    size_t batchSize = 500;
+  };
+
+  // Store jobs in job_outbox; call with a transaction open
+  template <typename Job>
+  static void write(std::span<const typename Job::Params> params,
+                    std::chrono::seconds delay = std::chrono::seconds(0)) {
+    (void)Registration<Job>::registered;
+
+    auto name = jobName<Job>();
+    auto availableAt = TimePoint::now() + delay;
+    for (size_t start = 0; start < params.size(); start += kRowsPerStatement) {
+      auto chunk = params.subspan(start, std::min(kRowsPerStatement, params.size() - start));
+
+      std::string sql = "INSERT INTO job_outbox (job, params, available_at) VALUES ";
+      std::vector<std::any> bindings;
+      for (const auto& item : chunk) {
+        auto bytes = encode(item);
+        auto data = reinterpret_cast<const std::byte*>(bytes.data());
+
+        sql += bindings.empty() ? "(?, ?, ?)" : ", (?, ?, ?)";
+        bindings.insert(bindings.end(), {name, std::vector<std::byte>(data, data + bytes.size()), availableAt});
+      }
+      Cyclone::Database::execute(sql, bindings);
+    }
+  }
+
+  // Hand the oldest `limit` rows of known job types to Pulse; returns how
+  // many rows were taken off the outbox
+  static size_t relay(size_t limit) {
+    size_t relayed = 0;
+
+    Cyclone::Database::transaction([&]() {
+      std::string sql = "SELECT id, job, params, available_at FROM job_outbox WHERE job IN (";
+      std::vector<std::any> names;
+      for (const auto& [name, entry] : registry()) {
+        sql += names.empty() ? "?" : ", ?";
+        names.emplace_back(name);
+      }
+      if (names.empty()) {
+        return;
+      }
+      sql += ") ORDER BY id LIMIT " + std::to_string(limit);
+      if (Cyclone::Database::adapter() == Cyclone::Database::Adapter::PostgreSQL) {
+        sql += " FOR UPDATE SKIP LOCKED";
+      }
+
+      struct Row {
+        int64_t id;
+        std::string job;
+        std::vector<std::byte> params;
+        TimePoint availableAt;
+      };
+      std::vector<Row> rows;
+      Cyclone::Database::eachRow(sql, names, [&](const Cyclone::Database::RowView& row) {
+        auto& added = rows.emplace_back();
+        added.id = row.get<int64_t>(0);
+        added.job = row.get<std::string>(1);
+        added.params = row.get<std::vector<std::byte>>(2);
+        added.availableAt = row.get<TimePoint>(3);
+      });
+      if (rows.empty()) {
+        return;
+      }
+
+      // Decode the whole batch before the pipeline, so an undecodable row is
+      // dropped on its own rather than failing (and retrying) the batch
+      auto now = TimePoint::now();
+      std::vector<int64_t> taken;
+      std::vector<Enqueue> enqueues;
+      for (const auto& row : rows) {
+        const auto& entry = registry().at(row.job);
+
+        auto delay = std::chrono::ceil<std::chrono::seconds>(row.availableAt - now);
+        delay = std::max(delay, std::chrono::seconds(0));
+        auto enqueue = entry.prepare({reinterpret_cast<const char*>(row.params.data()), row.params.size()}, delay);
+        if (enqueue) {
+          enqueues.push_back(std::move(enqueue));
+        } else {
+          Logger::error("Job outbox: dropping undecodable {}, id={}", row.job, row.id);
+        }
+        taken.push_back(row.id);
+      }
+
+      if (!enqueues.empty()) {
+        JobQueue::pipeline([&]() {
+          for (const auto& enqueue : enqueues) {
+            enqueue();
+          }
+        });
+      }
+
+      std::string remove = "DELETE FROM job_outbox WHERE id IN (";
+      std::vector<std::any> bindings;
+      for (auto id : taken) {
+        remove += bindings.empty() ? "?" : ", ?";
+        bindings.emplace_back(id);
+      }
+      Cyclone::Database::execute(remove + ")", bindings);
+      relayed = taken.size();
+    });
+
+    return relayed;
+  }
+
+  // Run the relay in a background thread until stop()
+  static void start(Options options) {
+    auto& slot = instance();
+    if (!slot) {
+      slot = std::make_unique<Relay>(options);
+    }
+  }
+
+  // Relay what is left, then stop the thread
+  static void stop() {
+    instance().reset();
+  }
+
+  // The job's own kOutboxName, stored in job_outbox.job
+  template <typename Job>
+  static std::string jobName() {
+    static_assert(requires { { Job::kOutboxName } -> std::convertible_to<std::string_view>; },
+                  "Jobs enqueued through the outbox declare static constexpr const char* kOutboxName");
+    return std::string(Job::kOutboxName);
+  }
+
+  struct JobType {
+    std::string name;
+    SerializeBench (*bench)(size_t iterations);
+  };
+
+  // Every job type registered with the relay, by name
+  static std::vector<JobType> jobTypes() {
+    std::vector<JobType> types;
+    for (const auto& [name, entry] : registry()) {
+      types.push_back({name, entry.bench});
+    }
+    std::sort(types.begin(), types.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+    return types;
+  }
+
+private:
+  // Three bindings per job
+  static constexpr size_t kRowsPerStatement = 1000;
+
+  // Enqueues one decoded row; empty when the row could not be decoded
+  using Enqueue = std::function<void()>;
+  using Prepare = Enqueue (*)(std::string_view params, std::chrono::seconds delay);
+
+  struct Entry {
+    Prepare prepare;
+    SerializeBench (*bench)(size_t iterations);
+  };
+
+  static std::unordered_map<std::string, Entry>& registry() {
+    static std::unordered_map<std::string, Entry> entries;
+    return entries;
+  }
+
+  // Instantiated by write<Job>() and initialised at startup, so the relay
+  // can decode rows left behind by an earlier run
+  template <typename Job>
+  struct Registration {
+    static Enqueue prepare(std::string_view bytes, std::chrono::seconds delay) {
+      typename Job::Params params{};
+      try {
+        params = decode<typename Job::Params>(bytes);
+      } catch (const std::exception& e) {
+        // Retrying cannot fix it; the relay drops it rather than block the outbox
+        Logger::error("Job outbox: cannot decode {}: {}", jobName<Job>(), e.what());
+        return {};
+      }
+
+      return [params, delay]() {
+        if (delay.count() > 0) {
+          JobQueue::enqueueIn<Job>(delay, params);
+        } else {
+          JobQueue::enqueue<Job>(params);
+        }
+      };
+    }
+
+    static SerializeBench bench(size_t iterations) {
+      if constexpr (requires { Job::Params::sample(); }) {
+        return benchSerialize(Job::Params::sample(), iterations);
+      } else {
+        return benchSerialize(typename Job::Params{}, iterations);
+      }
+    }
+
+    // Two job types claiming one name would decode each other's rows
+    static bool add() {
+      if (!registry().emplace(jobName<Job>(), Entry{&prepare, &bench}).second) {
+        throw std::logic_error("Job outbox: kOutboxName " + jobName<Job>() + " is taken by another job");
+      }
+      return true;
+    }
+
+    static inline const bool registered = add();
+  };
+
+  class Relay {
+  public:
+    explicit Relay(Options options) : options_(options) {
+      thread_ = std::thread([this] { run(); });
+    }
+
+    ~Relay() {
+      {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+      }
+      wake_.notify_all();
+      thread_.join();
+      drain();
+    }
+
+  private:
+    void run() {
+      std::unique_lock lock(mutex_);
+      while (!stopping_) {
+        lock.unlock();
+        drain();
+        lock.lock();
+        wake_.wait_for(lock, options_.pollInterval, [this] { return stopping_; });
+      }
+    }
+
+    // Full batches mean more is waiting; keep going until one comes up short
+    void drain() {
+      try {
+        while (relay(options_.batchSize) == options_.batchSize) {
+        }
+      } catch (const std::exception& e) {
+        Logger::error("Job outbox relay failed, retrying: {}", e.what());
+      }
+    }
+
+    Options options_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+  };
+
+  static std::unique_ptr<Relay>& instance() {
+    static std::unique_ptr<Relay> slot;
+    return slot;
+  }
+};
+
+} // namespace Jobs
@@ -0,0 +1,456 @@
+#pragma once
+
+#include "cyclone/engines/pulse.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Jobs {
+
+/**
+ * Work-stealing executor for Pulse
+ *
+ * Every queue belongs to a priority lane. Lanes are strict: before it starts
+ * a job, a worker looks for work in lane 0, then lane 1, and so on. So a burst
+ * in a low lane (reports) only runs on workers that have nothing from a
+ * higher lane (mail) to do. Queues that share a lane split it by weight
+ * (stride scheduling): with weights 2 and 1, the first queue gets two jobs
+ * for every one of the second while both have work.
+ *
+ *   lane 0   mailers (2)  notifications (1)
+ *   lane 1   default
+ *   lane 2   reports
+ *
+ * Submitted jobs wait in their queue. An idle worker takes up to `batchSize`
+ * jobs from the lane's next queue into its own Chase-Lev deque and runs them
+ * from the bottom. Other idle workers steal from the top, so one batch never
+ * waits behind one slow job. Optionally each worker is pinned to a core.
+ *
+ *   .executor = [](size_t workers) {
+ *     return std::make_shared<Jobs::WorkStealingPool>(Jobs::PoolOptions{
+ *       .workers = workers,
+ *       .queues = {{"mailers", 0, 2}, {"notifications", 0, 1}, {"default", 1}, {"reports", 2}}
+ *     });
+ *   }
+ *
+ * Pulse hands over each batch it dequeues (`.dequeue_batch` jobs leased in
+ * one round trip) through submitBatch(), which queues it under one lock.
+ * Jobs for a queue that is not listed run in "default" (or the last queue
+ * listed). Destroying the pool runs what was submitted, then joins.
+ */
+
+struct QueueOptions {
+  std::string name;
+  size_t lane = 0;      // 0 is the highest priority
+  unsigned weight = 1;  // Share within the lane
+};
+
+struct PoolOptions {
+  size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<QueueOptions> queues = {{"default"}};
+  size_t batchSize = 8;     // Jobs moved from a queue to a worker's deque at once
+  bool pinThreads = false;  // Worker i runs on core i % cores
+};
+
+// Chase-Lev work-stealing deque of owned pointers, fixed capacity. The owner
+// pushes and pops at the bottom, other threads steal from the top.
+template <typename T>
+class ChaseLevDeque {
+public:
+  explicit ChaseLevDeque(size_t capacity)
+    : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+      buffer_(capacity_) {}
+
+  ~ChaseLevDeque() {
+    while (auto* item = pop()) {
+      delete item;
+    }
+  }
+
+  // Owner only; false when full
+  bool push(T* item) {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(capacity_)) {
+      return false;
+    }
+
+    slot(bottom).store(item, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only; newest first
+  T* pop() {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T* item = slot(bottom).load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last item: race the thieves for it
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread; oldest first, nullptr when empty or on a lost race
+  T* steal() {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    T* item = slot(top).load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  bool empty() const {
+    return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return capacity_; }
+
+private:
+  std::atomic<T*>& slot(int64_t index) {
+    return buffer_[static_cast<size_t>(index) & (capacity_ - 1)];
+  }
+
+  size_t capacity_;
+  std::vector<std::atomic<T*>> buffer_;
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+};
+
+class WorkStealingPool : public Cyclone::Engines::Pulse::Executor {
+public:
+  using Task = std::function<void()>;
+
+  struct QueueStats {
+    std::string name;
+    size_t lane;
+    unsigned weight;
+    uint64_t dispatched;   // Jobs handed to workers so far
+  };
+
+  explicit WorkStealingPool(PoolOptions options) : options_(std::move(options)) {
+    if (options_.queues.empty()) {
+      options_.queues.push_back({"default"});
+    }
+    options_.workers = std::max<size_t>(options_.workers, 1);
+    options_.batchSize = std::max<size_t>(options_.batchSize, 1);
+
+    size_t laneCount = 0;
+    for (const auto& queue : options_.queues) {
+      laneCount = std::max(laneCount, queue.lane + 1);
+    }
+    lanes_ = std::vector<Lane>(laneCount);
+
+    queues_.reserve(options_.queues.size());
+    for (const auto& config : options_.queues) {
+      auto& queue = *queues_.emplace_back(std::make_unique<Queue>());
+      queue.name = config.name;
+      queue.lane = config.lane;
+      queue.weight = std::max(config.weight, 1u);
+      lanes_[config.lane].queues.push_back(&queue);
+      byName_.emplace(config.name, &queue);
+    }
+    auto fallback = byName_.find("default");
+    fallback_ = fallback != byName_.end() ? fallback->second : queues_.back().get();
+
+    workers_.reserve(options_.workers);
+    for (size_t i = 0; i < options_.workers; i++) {
+      workers_.push_back(std::make_unique<Worker>(laneCount, options_.batchSize));
+    }
+    for (size_t i = 0; i < options_.workers; i++) {
+      workers_[i]->thread = std::thread([this, i] { run(i); });
+      if (options_.pinThreads) {
+        pin(workers_[i]->thread, i);
+      }
+    }
+  }
+
+  ~WorkStealingPool() override {
+    {
+      std::lock_guard lock(idleMutex_);
+      stopping_ = true;
+    }
+    idle_.notify_all();
+    for (auto& worker : workers_) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+  }
+
+  void submit(const std::string& queueName, Task task) override {
+    auto& queue = queueFor(queueName);
+    auto& lane = lanes_[queue.lane];
+
+    {
+      std::lock_guard lock(lane.mutex);
+      level(queue, lane);
+      queue.tasks.push_back(std::make_unique<Task>(std::move(task)));
+    }
+    lane.queued.fetch_add(1, std::memory_order_release);
+
+    // Under the idle lock, so a worker that just found nothing cannot miss it
+    std::lock_guard lock(idleMutex_);
+    idle_.notify_one();
+  }
+
+  // A batch Pulse dequeued with one lease: queued under one lock, then
+  // enough workers woken for it
+  void submitBatch(const std::string& queueName, std::vector<Task> tasks) override {
+    if (tasks.empty()) {
+      return;
+    }
+
+    auto& queue = queueFor(queueName);
+    auto& lane = lanes_[queue.lane];
+
+    {
+      std::lock_guard lock(lane.mutex);
+      level(queue, lane);
+      for (auto& task : tasks) {
+        queue.tasks.push_back(std::make_unique<Task>(std::move(task)));
+      }
+    }
+    lane.queued.fetch_add(static_cast<int64_t>(tasks.size()), std::memory_order_release);
+
+    std::lock_guard lock(idleMutex_);
+    if (tasks.size() >= workers_.size()) {
+      idle_.notify_all();
+    } else {
+      for (size_t i = 0; i < tasks.size(); i++) {
+        idle_.notify_one();
+      }
+    }
+  }
+
+  size_t workerCount() const { return workers_.size(); }
+
+  std::vector<QueueStats> stats() const {
+    std::vector<QueueStats> result;
+    for (const auto& queue : queues_) {
+      result.push_back({queue->name, queue->lane, queue->weight, queue->dispatched.load(std::memory_order_relaxed)});
+    }
+    return result;
+  }
+
+private:
+  // Stride scheduling: each job a queue starts advances it by kStride / weight
+  static constexpr uint64_t kStride = 1 << 16;
+
+  struct Queue {
+    std::string name;
+    size_t lane = 0;
+    unsigned weight = 1;
+    uint64_t pass = 0;
+    std::deque<std::unique_ptr<Task>> tasks;
+    std::atomic<uint64_t> dispatched{0};
+  };
+
+  struct Lane {
+    std::mutex mutex;                 // Guards the queues' tasks and passes
+    std::vector<Queue*> queues;
+    uint64_t virtualTime = 0;
+    std::atomic<int64_t> queued{0};   // Submitted to the lane and not started yet
+  };
+
+  struct Worker {
+    Worker(size_t lanes, size_t batchSize) {
+      for (size_t i = 0; i < lanes; i++) {
+        deques.push_back(std::make_unique<ChaseLevDeque<Task>>(batchSize));
+      }
+    }
+
+    std::vector<std::unique_ptr<ChaseLevDeque<Task>>> deques;   // One per lane
+    std::thread thread;
+  };
+
+  Queue& queueFor(const std::string& name) {
+    auto found = byName_.find(name);
+    return found != byName_.end() ? *found->second : *fallback_;
+  }
+
+  // Called under the lane lock before adding to `queue`: a queue coming back
+  // from idle starts level with the lane, instead of cashing in the turns it
+  // had no work for
+  static void level(Queue& queue, Lane& lane) {
+    if (queue.tasks.empty()) {
+      queue.pass = std::max(queue.pass, lane.virtualTime);
+    }
+  }
+
+  void run(size_t index) {
+    auto& self = *workers_[index];
+    while (true) {
+      if (auto task = next(self, index)) {
+        execute(*task);
+        continue;
+      }
+
+      std::unique_lock lock(idleMutex_);
+      if (stopping_ && !anyQueued()) {
+        return;
+      }
+      idle_.wait(lock, [this] { return stopping_ || anyQueued(); });
+      if (stopping_ && !anyQueued()) {
+        return;
+      }
+    }
+  }
+
+  // The next job by lane: own deque, then the lane's queues, then the other
+  // workers' deques
+  std::unique_ptr<Task> next(Worker& self, size_t index) {
+    for (size_t lane = 0; lane < lanes_.size(); lane++) {
+      if (lanes_[lane].queued.load(std::memory_order_acquire) <= 0) {
+        continue;
+      }
+
+      if (auto* task = self.deques[lane]->pop()) {
+        return take(lane, task);
+      }
+      if (auto task = refill(self, lane)) {
+        return task;
+      }
+      for (size_t offset = 1; offset < workers_.size(); offset++) {
+        auto& victim = *workers_[(index + offset) % workers_.size()];
+        if (auto* task = victim.deques[lane]->steal()) {
+          return take(lane, task);
+        }
+      }
+
+      // Jobs of this lane are in flight between a queue and a deque; look
+      // again rather than run lower-priority work
+      std::this_thread::yield();
+      return nullptr;
+    }
+    return nullptr;
+  }
+
+  // Move the lane's next jobs into our deque and return the first
+  std::unique_ptr<Task> refill(Worker& self, size_t laneIndex) {
+    auto& lane = lanes_[laneIndex];
+    auto& deque = *self.deques[laneIndex];
+
+    std::unique_ptr<Task> first;
+    size_t moved = 0;
+    {
+      std::lock_guard lock(lane.mutex);
+      Queue* queue = nullptr;
+      for (auto* candidate : lane.queues) {
+        if (!candidate->tasks.empty() && (!queue || candidate->pass < queue->pass)) {
+          queue = candidate;
+        }
+      }
+      if (!queue) {
+        return nullptr;
+      }
+
+      first = std::move(queue->tasks.front());
+      queue->tasks.pop_front();
+      while (++moved < options_.batchSize && !queue->tasks.empty()) {
+        if (!deque.push(queue->tasks.front().get())) {
+          break;
+        }
+        queue->tasks.front().release();
+        queue->tasks.pop_front();
+      }
+
+      // Charged per job, so a whole batch waits its turn accordingly
+      queue->pass += moved * (kStride / queue->weight);
+      queue->dispatched.fetch_add(moved, std::memory_order_relaxed);
+      lane.virtualTime = queue->pass;
+    }
+
+    lane.queued.fetch_sub(1, std::memory_order_acq_rel);
+    if (moved > 1) {
+      // Let idle workers steal the rest of the batch
+      std::lock_guard lock(idleMutex_);
+      idle_.notify_all();
+    }
+    return first;
+  }
+
+  std::unique_ptr<Task> take(size_t lane, Task* task) {
+    lanes_[lane].queued.fetch_sub(1, std::memory_order_acq_rel);
+    return std::unique_ptr<Task>(task);
+  }
+
+  bool anyQueued() const {
+    for (const auto& lane : lanes_) {
+      if (lane.queued.load(std::memory_order_acquire) > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void execute(Task& task) {
+    try {
+      task();
+    } catch (const std::exception& e) {
+      Logger::error("Pulse worker: job raised {}", e.what());
+    } catch (...) {
+      Logger::error("Pulse worker: job raised an unknown exception");
+    }
+  }
+
+  static void pin(std::thread& thread, size_t index) {
+#ifdef __linux__
+    auto cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cores, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)index;
+#endif
+  }
+
+  PoolOptions options_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::unordered_map<std::string, Queue*> byName_;
+  Queue* fallback_ = nullptr;
+  std::vector<Lane> lanes_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex idleMutex_;
+  std::condition_variable idle_;
+  bool stopping_ = false;
+};
+
+} // namespace Jobs
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "cyclone/middleware.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+namespace Pipelines {
+
+/**
+ * Statically composed middleware chain
+ *
+ *   use(makePipeline(options,
+ *     RequestScopeMiddleware{},
+ *     Adapted<Cyclone::Middleware::RequestLogger>{},
+ *     ...));
+ *
+ * The whole stack is one middleware whose type lists every layer, so each hop
+ * is a direct call to the next layer's handle() with a lambda the compiler
+ * can inline, instead of a virtual process() plus a MiddlewareNext closure
+ * per layer.
+ *
+ * A layer is any type with
+ *
+ *   template <typename Next>
+ *   Cyclone::Response handle(const Cyclone::Request& request, Next&& next);
+ *
+ * Framework middleware only exposes the virtual process(); Adapted<> wraps it
+ * and passes the rest of the pipeline as a MiddlewareNext holding a
+ * std::reference_wrapper, which std::function stores without allocating.
+ *
+ * With `timing` enabled, every request logs the time spent in each layer
+ * itself (excluding the layers after it), and totals are kept in timings().
+ */
+
+struct PipelineOptions {
+  bool timing = false;
+};
+
+struct LayerTiming {
+  std::string name;
+  uint64_t calls = 0;
+  uint64_t selfNanos = 0;
+};
+
+inline std::string demangledName(const std::type_info& type) {
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  std::unique_ptr<char, void (*)(void*)> name(
+    abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free);
+  if (status == 0 && name) {
+    return name.get();
+  }
+#endif
+  return type.name();
+}
+
+// Runs a framework middleware as a pipeline layer
+template <typename M>
+class Adapted {
+public:
+  template <typename... Args>
+    requires std::constructible_from<M, Args&&...>
+  explicit Adapted(Args&&... args) : middleware_(std::forward<Args>(args)...) {}
+
+  template <typename Next>
+  Cyclone::Response handle(const Cyclone::Request& request, Next&& next) {
+    return middleware_.process(request, Cyclone::MiddlewareNext(std::ref(next)));
+  }
+
+  static std::string name() { return demangledName(typeid(M)); }
+
+private:
+  M middleware_;
+};
+
+template <typename... Layers>
+class Pipeline : public Cyclone::Middleware {
+public:
+  static constexpr size_t kLayerCount = sizeof...(Layers);
+
+  explicit Pipeline(PipelineOptions options, Layers... layers)
+    : options_(options), layers_(std::move(layers)...) {}
+
+  Cyclone::Response process(const Cyclone::Request& request, Cyclone::MiddlewareNext next) override {
+    if (!options_.timing) {
+      return run<0>(request, next);
+    }
+
+    // elapsed[i] is the time from entering layer i until it returns;
+    // elapsed[kLayerCount] is the application itself
+    std::array<int64_t, kLayerCount + 1> elapsed{};
+    auto response = runTimed<0>(request, next, elapsed);
+    record(elapsed);
+    return response;
+  }
+
+  std::vector<LayerTiming> timings() const {
+    auto names = layerNames();
+    std::vector<LayerTiming> result;
+    for (size_t i = 0; i < kLayerCount; ++i) {
+      result.push_back({names[i], totals_[i].calls.load(), totals_[i].selfNanos.load()});
+    }
+    return result;
+  }
+
+private:
+  template <size_t I>
+  Cyclone::Response run(const Cyclone::Request& request, Cyclone::MiddlewareNext& next) {
+    if constexpr (I == kLayerCount) {
+      return next(request);
+    } else {
+      return std::get<I>(layers_).handle(request, [&](const Cyclone::Request& forwarded) {
+        return run<I + 1>(forwarded, next);
+      });
+    }
+  }
+
+  template <size_t I>
+  Cyclone::Response runTimed(const Cyclone::Request& request, Cyclone::MiddlewareNext& next,
+                             std::array<int64_t, kLayerCount + 1>& elapsed) {
+    auto start = std::chrono::steady_clock::now();
+    auto response = [&]() {
+      if constexpr (I == kLayerCount) {
+        return next(request);
+      } else {
+        return std::get<I>(layers_).handle(request, [&](const Cyclone::Request& forwarded) {
+          return runTimed<I + 1>(forwarded, next, elapsed);
+        });
+      }
+    }();
+    elapsed[I] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count();
+    return response;
+  }
+
+  void record(const std::array<int64_t, kLayerCount + 1>& elapsed) {
+    static const auto names = layerNames();
+
+    std::string line = "Middleware timings (us):";
+    for (size_t i = 0; i < kLayerCount; ++i) {
+      // A layer that short-circuits never reaches the next one
+      auto self = elapsed[i] - elapsed[i + 1];
+      totals_[i].calls.fetch_add(1, std::memory_order_relaxed);
+      totals_[i].selfNanos.fetch_add(static_cast<uint64_t>(self), std::memory_order_relaxed);
+
+      appendTiming(line, names[i], self);
+    }
+    appendTiming(line, "app", elapsed[kLayerCount]);
+
+    Logger::info("{}", line);
+  }
+
+  static void appendTiming(std::string& line, const std::string& name, int64_t nanos) {
+    char micros[32];
+    std::snprintf(micros, sizeof(micros), "=%.1f", nanos / 1000.0);
+    line += ' ';
+    line += name;
+    line += micros;
+  }
+
+  static std::vector<std::string> layerNames() {
+    return {nameOf<Layers>()...};
+  }
+
+  template <typename Layer>
+  static std::string nameOf() {
+    if constexpr (requires { Layer::name(); }) {
+      return Layer::name();
+    } else {
+      return demangledName(typeid(Layer));
+    }
+  }
+
+  struct Totals {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> selfNanos{0};
+  };
+
+  PipelineOptions options_;
+  std::tuple<Layers...> layers_;
+  std::array<Totals, kLayerCount> totals_;
+};
+
+template <typename... Layers>
+std::shared_ptr<Pipeline<Layers...>> makePipeline(PipelineOptions options, Layers... layers) {
+  return std::make_shared<Pipeline<Layers...>>(options, std::move(layers)...);
+}
+
+} // namespace Pipelines
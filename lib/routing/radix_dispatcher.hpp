@@ -0,0 +1,101 @@
+#pragma once
+
+#include "cyclone/routing.hpp"
+#include "radix_trie.hpp"
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if __has_include("routes/route_table.hpp")
+#include "routes/route_table.hpp"
+#define CYCLONE_GENERATED_ROUTE_TABLE 1
+#endif
+
+namespace Routing {
+
+/**
+ * Route dispatcher backed by a flattened radix trie
+ *
+ * Installed at the end of configureRoutes(), once the `get` / `resources` /
+ * `namespace` / `authenticate` DSL has expanded into the router's flat route
+ * list. Route ids are indexes into that list, so the framework still runs the
+ * route's middleware and handler; only matching changes.
+ *
+ * When the build ran the `route_table` step, the trie was already generated
+ * as constexpr data and startup only checks its fingerprint. If the routes
+ * changed since (e.g. development reloads), the trie is built at startup.
+ */
+class RadixDispatcher : public Cyclone::RouteDispatcher {
+public:
+  explicit RadixDispatcher(const std::vector<Cyclone::RouteDefinition>& routes) {
+    std::vector<std::pair<Method, std::string_view>> entries;
+    entries.reserve(routes.size());
+    paramNames_.reserve(routes.size());
+
+    for (const auto& route : routes) {
+      auto method = parseMethod(route.method);
+      if (!method) {
+        throw std::invalid_argument("Unsupported HTTP method for route " + route.path);
+      }
+      entries.emplace_back(*method, route.path);
+      paramNames_.push_back(paramNamesOf(route.path));
+    }
+
+#ifdef CYCLONE_GENERATED_ROUTE_TABLE
+    if (routeFingerprint(entries) == Generated::kRouteFingerprint) {
+      table_ = FlatTable(Generated::kNodes, Generated::kLabels);
+      generated_ = true;
+      return;
+    }
+#endif
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+      builder_.add(entries[i].first, entries[i].second, static_cast<int32_t>(i));
+    }
+    table_ = builder_.build();
+  }
+
+  std::optional<Cyclone::RouteMatch> match(std::string_view method, std::string_view path) const override {
+    auto parsedMethod = parseMethod(method);
+    if (!parsedMethod) {
+      return std::nullopt;
+    }
+
+    auto found = table_.match(*parsedMethod, path);
+    if (!found) {
+      return std::nullopt;
+    }
+
+    Cyclone::RouteMatch result{.route = static_cast<size_t>(found->route)};
+    const auto& names = paramNames_[found->route];
+    for (uint8_t i = 0; i < found->paramCount; ++i) {
+      result.params.add(names[i], found->params[i].raw);
+    }
+    return result;
+  }
+
+  const FlatTable& table() const { return table_; }
+
+  // True when the build-time table is in use
+  bool generated() const { return generated_; }
+
+private:
+  static std::vector<std::string> paramNamesOf(std::string_view pattern) {
+    std::vector<std::string> names;
+    for (size_t colon = pattern.find(':'); colon != std::string_view::npos; colon = pattern.find(':', colon + 1)) {
+      auto end = pattern.find('/', colon);
+      names.emplace_back(pattern.substr(colon + 1, end == std::string_view::npos ? std::string_view::npos : end - colon - 1));
+    }
+    return names;
+  }
+
+  RadixTrieBuilder builder_;
+  FlatTable table_;
+  bool generated_ = false;
+  std::vector<std::vector<std::string>> paramNames_;
+};
+
+} // namespace Routing
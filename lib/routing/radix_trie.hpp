@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Routing {
+
+/**
+ * Compressed radix trie for route dispatch
+ *
+ * Route patterns ("/posts/:post_id/comments/:id") are merged into a trie whose
+ * static edges carry whole shared prefixes, then flattened into two arrays:
+ * nodes (children stored contiguously) and one pool of edge labels. A lookup
+ * is a single walk over those arrays; it never allocates and reads captured
+ * segments as string_views into the request path.
+ *
+ * Parameters are typed by name: `:id` and `:<name>_id` only match digit runs
+ * and are parsed to integers during the walk, everything else matches any
+ * non-empty segment. Static edges win over parameters, integer parameters
+ * over string ones, with backtracking if a branch dead-ends.
+ *
+ * The flattened form is plain data, so tools/route_gen can emit it as a
+ * constexpr table at build time (see radix_dispatcher.hpp).
+ */
+
+enum class Method : uint8_t { Get, Post, Put, Patch, Delete, Head, Options };
+
+inline constexpr size_t kMethodCount = 7;
+inline constexpr size_t kMaxParams = 8;
+inline constexpr int32_t kNone = -1;
+
+inline std::optional<Method> parseMethod(std::string_view name) {
+  static constexpr std::array<std::string_view, kMethodCount> kNames = {
+    "GET", "POST", "PUT", "PATCH", "DELETE", "HEAD", "OPTIONS"
+  };
+  for (size_t i = 0; i < kNames.size(); ++i) {
+    if (kNames[i] == name) {
+      return static_cast<Method>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+struct FlatNode {
+  uint32_t labelOffset = 0;       // Static edge label leading into this node
+  uint32_t labelLength = 0;
+  uint32_t firstChild = 0;        // Static children, sorted by first label byte
+  uint32_t childCount = 0;
+  int32_t integerParam = kNone;   // Child matching an integer segment
+  int32_t stringParam = kNone;    // Child matching any segment
+  std::array<int32_t, kMethodCount> routes = {kNone, kNone, kNone, kNone, kNone, kNone, kNone};
+};
+
+struct Param {
+  std::string_view raw;
+  int64_t integer = 0;
+  bool isInteger = false;
+};
+
+struct Match {
+  int32_t route = kNone;
+  uint8_t paramCount = 0;
+  std::array<Param, kMaxParams> params;
+};
+
+// `:id` and `:post_id` are integer parameters
+constexpr bool isIntegerParam(std::string_view name) {
+  return name == "id" || (name.size() > 3 && name.substr(name.size() - 3) == "_id");
+}
+
+// A flattened trie; the storage is either owned (RadixTrieBuilder) or a
+// generated constexpr table
+class FlatTable {
+public:
+  constexpr FlatTable() = default;
+  constexpr FlatTable(std::span<const FlatNode> nodes, std::string_view labels)
+    : nodes_(nodes), labels_(labels) {}
+
+  std::span<const FlatNode> nodes() const { return nodes_; }
+  std::string_view labels() const { return labels_; }
+
+  std::optional<Match> match(Method method, std::string_view path) const {
+    if (nodes_.empty()) {
+      return std::nullopt;
+    }
+
+    // Queries are not part of the route; "/posts/" routes like "/posts"
+    if (auto query = path.find('?'); query != std::string_view::npos) {
+      path = path.substr(0, query);
+    }
+    if (path.size() > 1 && path.back() == '/') {
+      path.remove_suffix(1);
+    }
+
+    Match result;
+    if (!walk(0, path, static_cast<size_t>(method), result)) {
+      return std::nullopt;
+    }
+    return result;
+  }
+
+private:
+  std::string_view label(const FlatNode& node) const {
+    return labels_.substr(node.labelOffset, node.labelLength);
+  }
+
+  bool walk(uint32_t index, std::string_view rest, size_t method, Match& result) const {
+    const auto& node = nodes_[index];
+
+    if (rest.empty()) {
+      result.route = node.routes[method];
+      return result.route != kNone;
+    }
+
+    // At most one static child can start with the next byte
+    auto children = nodes_.subspan(node.firstChild, node.childCount);
+    auto child = std::lower_bound(children.begin(), children.end(), rest.front(),
+      [&](const FlatNode& candidate, char byte) { return labels_[candidate.labelOffset] < byte; });
+
+    if (child != children.end() && labels_[child->labelOffset] == rest.front()) {
+      auto edge = label(*child);
+      if (rest.starts_with(edge)) {
+        auto childIndex = static_cast<uint32_t>(node.firstChild + (child - children.begin()));
+        if (walk(childIndex, rest.substr(edge.size()), method, result)) {
+          return true;
+        }
+      }
+    }
+
+    if (node.integerParam == kNone && node.stringParam == kNone) {
+      return false;
+    }
+    if (result.paramCount == kMaxParams) {
+      return false;
+    }
+
+    auto segment = rest.substr(0, rest.find('/'));
+    if (segment.empty()) {
+      return false;
+    }
+
+    auto& param = result.params[result.paramCount];
+    if (node.integerParam != kNone && parseInteger(segment, param.integer)) {
+      param.raw = segment;
+      param.isInteger = true;
+      ++result.paramCount;
+      if (walk(static_cast<uint32_t>(node.integerParam), rest.substr(segment.size()), method, result)) {
+        return true;
+      }
+      --result.paramCount;
+    }
+
+    if (node.stringParam != kNone) {
+      param = {segment, 0, false};
+      ++result.paramCount;
+      if (walk(static_cast<uint32_t>(node.stringParam), rest.substr(segment.size()), method, result)) {
+        return true;
+      }
+      --result.paramCount;
+    }
+
+    return false;
+  }
+
+  static bool parseInteger(std::string_view digits, int64_t& value) {
+    if (digits.size() > 18) {
+      return false;
+    }
+    value = 0;
+    for (char c : digits) {
+      if (c < '0' || c > '9') {
+        return false;
+      }
+      value = value * 10 + (c - '0');
+    }
+    return true;
+  }
+
+  std::span<const FlatNode> nodes_;
+  std::string_view labels_;
+};
+
+// Builds and owns a FlatTable from route patterns
+class RadixTrieBuilder {
+public:
+  // Route ids are the caller's (normally the registration index)
+  void add(Method method, std::string_view pattern, int32_t route) {
+    auto* node = root_.get();
+
+    while (!pattern.empty()) {
+      if (pattern.front() == ':') {
+        auto end = pattern.find('/');
+        auto name = pattern.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+        if (name.empty()) {
+          throw std::invalid_argument("Unnamed route parameter in " + std::string(pattern));
+        }
+
+        auto& param = isIntegerParam(name) ? node->integerParam : node->stringParam;
+        if (!param) {
+          param = std::make_unique<Node>();
+        }
+        node = param.get();
+        pattern.remove_prefix(name.size() + 1);
+        continue;
+      }
+
+      auto staticEnd = std::min(pattern.find(':'), pattern.size());
+      node = insertStatic(*node, pattern.substr(0, staticEnd));
+      pattern.remove_prefix(staticEnd);
+    }
+
+    auto& slot = node->routes[static_cast<size_t>(method)];
+    if (slot == kNone) {
+      slot = route;  // First registration wins, as with the framework router
+    }
+  }
+
+  // Flatten into contiguous arrays; the returned table points into this builder
+  FlatTable build() {
+    nodes_.clear();
+    labels_.clear();
+
+    nodes_.emplace_back();
+    flatten(*root_, 0);
+    return table();
+  }
+
+  FlatTable table() const {
+    return FlatTable(nodes_, labels_);
+  }
+
+private:
+  struct Node {
+    std::string label;
+    std::vector<std::unique_ptr<Node>> children;
+    std::unique_ptr<Node> integerParam;
+    std::unique_ptr<Node> stringParam;
+    std::array<int32_t, kMethodCount> routes = {kNone, kNone, kNone, kNone, kNone, kNone, kNone};
+  };
+
+  // Walk or split static edges so that `text` ends exactly at a node
+  static Node* insertStatic(Node& parent, std::string_view text) {
+    auto* node = &parent;
+
+    while (!text.empty()) {
+      auto it = std::find_if(node->children.begin(), node->children.end(),
+        [&](const auto& child) { return child->label.front() == text.front(); });
+
+      if (it == node->children.end()) {
+        auto child = std::make_unique<Node>();
+        child->label = std::string(text);
+        node->children.push_back(std::move(child));
+        return node->children.back().get();
+      }
+
+      auto& child = *it;
+      auto common = std::mismatch(child->label.begin(), child->label.end(), text.begin(), text.end());
+      auto shared = static_cast<size_t>(common.first - child->label.begin());
+
+      if (shared < child->label.size()) {
+        // Split "posts" into "post" -> "s" when inserting "postal"
+        auto tail = std::make_unique<Node>();
+        tail->label = child->label.substr(shared);
+        tail->children = std::move(child->children);
+        tail->integerParam = std::move(child->integerParam);
+        tail->stringParam = std::move(child->stringParam);
+        tail->routes = child->routes;
+
+        child->label.resize(shared);
+        child->children.clear();
+        child->children.push_back(std::move(tail));
+        child->routes.fill(kNone);
+      }
+
+      node = child.get();
+      text.remove_prefix(shared);
+    }
+
+    return node;
+  }
+
+  void flatten(Node& node, size_t index) {
+    std::sort(node.children.begin(), node.children.end(),
+      [](const auto& a, const auto& b) { return a->label.front() < b->label.front(); });
+
+    // Reserve the whole sibling block first so children stay contiguous
+    auto firstChild = nodes_.size();
+    for (const auto& child : node.children) {
+      FlatNode flat;
+      flat.labelOffset = static_cast<uint32_t>(labels_.size());
+      flat.labelLength = static_cast<uint32_t>(child->label.size());
+      labels_ += child->label;
+      nodes_.push_back(flat);
+    }
+
+    auto integerParam = node.integerParam ? appendParam() : kNone;
+    auto stringParam = node.stringParam ? appendParam() : kNone;
+
+    nodes_[index].firstChild = static_cast<uint32_t>(firstChild);
+    nodes_[index].childCount = static_cast<uint32_t>(node.children.size());
+    nodes_[index].integerParam = integerParam;
+    nodes_[index].stringParam = stringParam;
+    nodes_[index].routes = node.routes;
+
+    for (size_t i = 0; i < node.children.size(); ++i) {
+      flatten(*node.children[i], firstChild + i);
+    }
+    if (node.integerParam) {
+      flatten(*node.integerParam, static_cast<size_t>(integerParam));
+    }
+    if (node.stringParam) {
+      flatten(*node.stringParam, static_cast<size_t>(stringParam));
+    }
+  }
+
+  int32_t appendParam() {
+    nodes_.emplace_back();
+    return static_cast<int32_t>(nodes_.size() - 1);
+  }
+
+  std::unique_ptr<Node> root_ = std::make_unique<Node>();
+  std::vector<FlatNode> nodes_;
+  std::string labels_;
+};
+
+// Identifies a route list, so a generated table is only used for the routes
+// it was generated from
+inline uint64_t routeFingerprint(std::span<const std::pair<Method, std::string_view>> routes) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto mix = [&](std::string_view text) {
+    for (unsigned char c : text) {
+      hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+  };
+
+  for (const auto& [method, pattern] : routes) {
+    hash = (hash ^ static_cast<uint8_t>(method)) * 0x100000001b3ULL;
+    mix(pattern);
+    mix("\n");
+  }
+  return hash;
+}
+
+} // namespace Routing
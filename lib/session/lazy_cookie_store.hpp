@@ -0,0 +1,263 @@
+#pragma once
+
+#include "cyclone/crypto.hpp"
+#include "cyclone/http.hpp"
+#include "cyclone/session.hpp"
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Sessions {
+
+/**
+ * Signed cookie session store that decodes on demand
+ *
+ * The eager cookie store verifies and parses `cyclone_session` on every
+ * request and re-signs it on every response. This store only copies the raw
+ * cookie when the request starts:
+ *
+ *   - the HMAC check and JSON parse run on the first read of the session;
+ *   - the response only gets a new Set-Cookie when a value actually changed
+ *     (or the cookie is due for its sliding-expiry refresh);
+ *   - the cookie carries a flash marker outside the payload, so reading an
+ *     empty flash (which FlashMessages does on every request) is answered
+ *     without decoding.
+ *
+ * Cookie format: `<flags>.<issued>.<base64url(json)>.<base64url(hmac)>`. The
+ * HMAC covers everything before the last dot. Flags and issue time are read unverified,
+ * but only to skip work: a forged "no flash" marker can only hide the
+ * client's own flash, and anything that is actually used is verified first.
+ *
+ * An anonymous request without a session cookie never touches the crypto.
+ *
+ * A cookie signed more than `max_age` seconds ago decodes as an empty
+ * session, whatever expiry the browser kept, so a captured cookie stops
+ * working once it is that old.
+ */
+
+using StoreOptions = std::map<std::string, std::string>;
+
+inline constexpr std::string_view kFlashKey = "_flash";
+
+namespace detail {
+
+  inline int64_t secondsSinceEpoch() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+} // namespace detail
+
+class LazyCookieSession : public Cyclone::SessionData {
+public:
+  LazyCookieSession(std::string cookie, const std::string& secret, int64_t maxAge)
+    : cookie_(std::move(cookie)), secret_(secret), maxAge_(maxAge) {
+    parseEnvelope();
+  }
+
+  const Cyclone::Json* find(std::string_view key) override {
+    // An empty flash is by far the most common read
+    if (key == kFlashKey && !loaded_ && !flashMarked_) {
+      return nullptr;
+    }
+
+    auto& data = load();
+    auto it = data.find(key);
+    return it == data.end() ? nullptr : &*it;
+  }
+
+  void set(const std::string& key, Cyclone::Json value) override {
+    auto& data = load();
+    if (auto it = data.find(key); it != data.end() && *it == value) {
+      return;
+    }
+    data[key] = std::move(value);
+    dirty_ = true;
+  }
+
+  bool erase(std::string_view key) override {
+    if (key == kFlashKey && !loaded_ && !flashMarked_) {
+      return false;
+    }
+
+    auto& data = load();
+    if (data.erase(std::string(key)) == 0) {
+      return false;
+    }
+    dirty_ = true;
+    return true;
+  }
+
+  void clear() override {
+    if (!cookie_.empty() || (loaded_ && !data_.empty())) {
+      dirty_ = true;
+    }
+    data_ = Cyclone::Json::object();
+    loaded_ = true;
+  }
+
+  bool present() const { return !cookie_.empty(); }
+  bool loaded() const { return loaded_; }
+  bool dirty() const { return dirty_; }
+
+  // Seconds since epoch when the cookie was last signed, 0 if unknown
+  int64_t issuedAt() const { return issuedAt_; }
+
+  // Make sure the data is decoded and verified, e.g. before re-signing
+  Cyclone::Json& load() {
+    if (!loaded_) {
+      data_ = decode().value_or(Cyclone::Json::object());
+      loaded_ = true;
+    }
+    return data_;
+  }
+
+private:
+  void parseEnvelope() {
+    std::string_view cookie = cookie_;
+
+    auto flagsEnd = cookie.find('.');
+    auto issuedEnd = flagsEnd == std::string_view::npos ? flagsEnd : cookie.find('.', flagsEnd + 1);
+    if (issuedEnd == std::string_view::npos) {
+      // Not ours (e.g. left over from the eager store); decode() rejects it
+      flashMarked_ = true;
+      return;
+    }
+
+    flashMarked_ = cookie.substr(0, flagsEnd).find('f') != std::string_view::npos;
+    auto issued = cookie.substr(flagsEnd + 1, issuedEnd - flagsEnd - 1);
+    std::from_chars(issued.data(), issued.data() + issued.size(), issuedAt_);
+  }
+
+  std::optional<Cyclone::Json> decode() const {
+    std::string_view cookie = cookie_;
+    if (cookie.empty()) {
+      return std::nullopt;
+    }
+
+    auto separator = cookie.rfind('.');
+    if (separator == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    auto signedPart = cookie.substr(0, separator);
+    auto signature = Cyclone::Crypto::base64UrlDecode(cookie.substr(separator + 1));
+    if (!signature || !Cyclone::Crypto::secureCompare(*signature, Cyclone::Crypto::hmacSha256(secret_, signedPart))) {
+      return std::nullopt;
+    }
+
+    // The issue time is verified now; past max_age the session is over
+    auto flagsEnd = signedPart.find('.');
+    auto payloadStart = signedPart.rfind('.');
+    if (flagsEnd == payloadStart) {
+      return std::nullopt;
+    }
+    int64_t issued = 0;
+    auto digits = signedPart.substr(flagsEnd + 1, payloadStart - flagsEnd - 1);
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), issued);
+    if (error != std::errc() || end != digits.data() + digits.size() ||
+        detail::secondsSinceEpoch() - issued > maxAge_) {
+      return std::nullopt;
+    }
+
+    auto payload = Cyclone::Crypto::base64UrlDecode(signedPart.substr(payloadStart + 1));
+    if (!payload) {
+      return std::nullopt;
+    }
+
+    auto data = Cyclone::Json::parse(*payload, /* throwOnError */ false);
+    if (!data.isObject()) {
+      return std::nullopt;
+    }
+    return data;
+  }
+
+  std::string cookie_;
+  const std::string& secret_;
+  int64_t maxAge_;
+
+  Cyclone::Json data_;
+  bool loaded_ = false;
+  bool dirty_ = false;
+  bool flashMarked_ = false;
+  int64_t issuedAt_ = 0;
+};
+
+class LazyCookieStore : public Cyclone::SessionBackend {
+public:
+  explicit LazyCookieStore(const StoreOptions& options)
+    : key_(option(options, "key", "cyclone_session")),
+      secret_(option(options, "secret", "")),
+      maxAge_(std::stoll(option(options, "max_age", "2592000"))) {
+    if (secret_.empty()) {
+      throw std::invalid_argument("LazyCookieStore requires a secret");
+    }
+  }
+
+  std::unique_ptr<Cyclone::SessionData> open(const Cyclone::Request& request) override {
+    auto cookie = request.cookie(key_);
+    return std::make_unique<LazyCookieSession>(cookie ? std::string(*cookie) : std::string(), secret_, maxAge_);
+  }
+
+  void commit(Cyclone::SessionData& data, Cyclone::Response& response) override {
+    auto& session = static_cast<LazyCookieSession&>(data);
+
+    if (!session.dirty() && !dueForRefresh(session)) {
+      return;
+    }
+
+    auto& values = session.load();
+    if (values.empty()) {
+      if (session.present()) {
+        response.setCookie(key_, "", cookieOptions(0));
+      }
+      return;
+    }
+
+    response.setCookie(key_, encode(values), cookieOptions(maxAge_));
+  }
+
+private:
+  // Re-issue unchanged sessions halfway through their lifetime so that the
+  // expiry keeps sliding for active users
+  bool dueForRefresh(const LazyCookieSession& session) const {
+    if (!session.present()) {
+      return false;
+    }
+    return detail::secondsSinceEpoch() - session.issuedAt() > maxAge_ / 2;
+  }
+
+  std::string encode(const Cyclone::Json& values) const {
+    auto flash = values.find(kFlashKey);
+    bool hasFlash = flash != values.end() && !flash->empty();
+
+    std::string signedPart = hasFlash ? "f." : "-.";
+    signedPart += std::to_string(detail::secondsSinceEpoch());
+    signedPart += '.';
+    signedPart += Cyclone::Crypto::base64UrlEncode(values.dump());
+
+    return signedPart + "." + Cyclone::Crypto::base64UrlEncode(Cyclone::Crypto::hmacSha256(secret_, signedPart));
+  }
+
+  Cyclone::CookieOptions cookieOptions(int64_t maxAge) const {
+    return {.maxAge = maxAge, .path = "/", .httpOnly = true, .sameSite = "Lax"};
+  }
+
+  static std::string option(const StoreOptions& options, const std::string& name, const std::string& fallback) {
+    auto it = options.find(name);
+    return it == options.end() ? fallback : it->second;
+  }
+
+  std::string key_;
+  std::string secret_;
+  int64_t maxAge_;
+};
+
+} // namespace Sessions
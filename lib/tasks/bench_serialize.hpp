@@ -0,0 +1,39 @@
+#pragma once
+
+#include "cyclone/task.hpp"
+#include "../../app/jobs/notification_job.hpp"
+#include "../jobs/outbox.hpp"
+#include <cstdio>
+#include <string>
+
+namespace Tasks {
+
+    // bin/cy pulse:bench-serialize
+    // Encodes and decodes the Params of every job type registered with the
+    // job outbox through the binary archive. Uses Params::sample() when the
+    // job defines it, default Params otherwise.
+    class BenchSerialize : public Cyclone::Task {
+    public:
+        std::string description() const override {
+            return "Report bytes and encode/decode ns per job for every registered job type";
+        }
+
+        void run(const Cyclone::TaskArgs& args) override {
+            constexpr size_t kIterations = 1000000;
+
+            auto jobTypes = Jobs::Outbox::jobTypes();
+            std::printf("%zu job types, archive version %d\n\n", jobTypes.size(), Jobs::kArchiveVersion);
+            std::printf("%-32s %8s %12s %12s\n", "Job", "Bytes", "ns/encode", "ns/decode");
+
+            for (const auto& jobType : jobTypes) {
+                auto result = jobType.bench(kIterations);
+                std::printf("%-32s %8zu %12.1f %12.1f\n", jobType.name.c_str(),
+                            result.bytes, result.encodeNs, result.decodeNs);
+            }
+        }
+    };
+
+} // namespace Tasks
+
+// Register task
+CYCLONE_REGISTER_TASK(Tasks::BenchSerialize, "pulse:bench-serialize");
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "cyclone/task.hpp"
+#include "../../app/models/post.hpp"
+#include "../../app/models/comment.hpp"
+#include "../../app/models/like.hpp"
+#include "../../app/models/concerns/counter_cache.hpp"
+
+namespace Tasks {
+
+    // bin/cy db:counters:rebuild
+    // Recomputes every counter cache column declared with counterCache<>().
+    class RebuildCounterCaches : public Cyclone::Task {
+    public:
+        std::string description() const override {
+            return "Recompute counter cache columns (posts.comments_count, likes_count, ...)";
+        }
+
+        void run(const Cyclone::TaskArgs& args) override {
+            // Make sure every model has registered its counters
+            Post::defineSchema();
+            Comment::defineSchema();
+            Like::defineSchema();
+
+            for (const auto& definition : CounterCache::definitions()) {
+                Cyclone::Database::transaction([&]() {
+                    CounterCache::rebuild(definition);
+                });
+
+                Logger::info("Rebuilt {}.{} from {}",
+                             definition.parentTable,
+                             definition.options.column,
+                             definition.childTable);
+            }
+        }
+    };
+
+} // namespace Tasks
+
+// Register task
+CYCLONE_REGISTER_TASK(Tasks::RebuildCounterCaches, "db:counters:rebuild");
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "cyclone/task.hpp"
+#include "../../app/models/post.hpp"
+#include "../database/batches.hpp"
+#include <cstdio>
+#include <string>
+
+namespace Tasks {
+
+    // bin/cy db:export:posts > posts.csv
+    // Writes every post as CSV, streaming 1000 rows at a time into PostRow
+    // structs so memory stays flat however large the table is.
+    class ExportPosts : public Cyclone::Task {
+    public:
+        std::string description() const override {
+            return "Stream all posts to stdout as CSV (id, user_id, title, published, likes_count, comments_count)";
+        }
+
+        void run(const Cyclone::TaskArgs& args) override {
+            std::printf("id,user_id,title,published,likes_count,comments_count\n");
+
+            findEach<PostRow>(Post::query(), 1000, [](const PostRow& post) {
+                std::printf("%d,%d,%s,%d,%d,%d\n",
+                            post.id,
+                            post.user_id,
+                            quote(post.title).c_str(),
+                            post.published ? 1 : 0,
+                            post.likes_count,
+                            post.comments_count);
+            });
+        }
+
+    private:
+        static std::string quote(const std::string& field) {
+            std::string quoted = "\"";
+            for (char c : field) {
+                quoted += c;
+                if (c == '"') {
+                    quoted += '"';
+                }
+            }
+            return quoted + "\"";
+        }
+    };
+
+} // namespace Tasks
+
+// Register task
+CYCLONE_REGISTER_TASK(Tasks::ExportPosts, "db:export:posts");
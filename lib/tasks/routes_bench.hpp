@@ -0,0 +1,78 @@
+#pragma once
+
+#include "cyclone/task.hpp"
+#include "../../config/routes.hpp"
+#include "../routing/radix_dispatcher.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace Tasks {
+
+    // bin/cy routes:bench
+    // Times a trie dispatch for every registered route, using a sample path
+    // with `42` for integer parameters and `sample` for the others.
+    class BenchRoutes : public Cyclone::Task {
+    public:
+        std::string description() const override {
+            return "Report ns/dispatch of the radix route table for every route";
+        }
+
+        void run(const Cyclone::TaskArgs& args) override {
+            constexpr int kIterations = 200000;
+
+            Cyclone::Router router;
+            configureRoutes(router);
+
+            const auto& routes = router.routes();
+            Routing::RadixDispatcher dispatcher(routes);
+            const auto& table = dispatcher.table();
+
+            std::printf("%zu routes, %zu trie nodes (%s table)\n\n",
+                        routes.size(), table.nodes().size(),
+                        dispatcher.generated() ? "generated" : "startup");
+            std::printf("%-8s %-40s %12s\n", "Method", "Path", "ns/dispatch");
+
+            for (const auto& route : routes) {
+                auto method = *Routing::parseMethod(route.method);
+                auto path = samplePath(route.path);
+
+                // Keep the optimizer from dropping the walk
+                volatile int32_t sink = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < kIterations; ++i) {
+                    auto match = table.match(method, path);
+                    sink = match ? match->route : Routing::kNone;
+                }
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                (void)sink;
+
+                auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+                std::printf("%-8s %-40s %12.1f\n", route.method.c_str(), route.path.c_str(), ns);
+            }
+        }
+
+    private:
+        static std::string samplePath(const std::string& pattern) {
+            std::string path;
+            for (size_t i = 0; i < pattern.size();) {
+                if (pattern[i] != ':') {
+                    path += pattern[i++];
+                    continue;
+                }
+
+                auto end = pattern.find('/', i);
+                if (end == std::string::npos) {
+                    end = pattern.size();
+                }
+                path += Routing::isIntegerParam(std::string_view(pattern).substr(i + 1, end - i - 1)) ? "42" : "sample";
+                i = end;
+            }
+            return path;
+        }
+    };
+
+} // namespace Tasks
+
+// Register task
+CYCLONE_REGISTER_TASK(Tasks::BenchRoutes, "routes:bench");
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Mentions {
+
+/**
+ * @mention extraction without std::regex
+ *
+ *   Mentions::scan("thanks @alice and @bob_2, cc @alice")  // {"alice", "bob_2"}
+ *
+ * One forward pass over the text: an '@' followed by one or more of
+ * [A-Za-z0-9_] is a mention, exactly what "@([a-zA-Z0-9_]+)" matched. Names
+ * are returned once each, in order of first appearance, as views into `text`.
+ */
+
+constexpr bool isNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+inline std::vector<std::string_view> scan(std::string_view text) {
+  std::vector<std::string_view> names;
+  std::unordered_set<std::string_view> seen;
+
+  size_t at = text.find('@');
+  while (at != std::string_view::npos) {
+    size_t end = at + 1;
+    while (end < text.size() && isNameChar(text[end])) {
+      end++;
+    }
+
+    if (end > at + 1) {
+      auto name = text.substr(at + 1, end - at - 1);
+      if (seen.insert(name).second) {
+        names.push_back(name);
+      }
+    }
+
+    at = text.find('@', end == at + 1 ? at + 1 : end);
+  }
+
+  return names;
+}
+
+} // namespace Mentions
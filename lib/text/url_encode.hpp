@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Url {
+
+/**
+ * Percent-encoding for one query string value
+ *
+ *   "/admin/posts?search=" + Url::encode("a&b c")   // "...search=a%26b%20c"
+ *
+ * Everything except the RFC 3986 unreserved characters [A-Za-z0-9-._~] is
+ * encoded, so a value cannot end its parameter (&, =), the query (#) or the
+ * attribute it is written into.
+ */
+
+constexpr bool isUnreserved(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+         c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+inline std::string encode(std::string_view value) {
+  static constexpr char kHex[] = "0123456789ABCDEF";
+
+  std::string encoded;
+  encoded.reserve(value.size());
+  for (char c : value) {
+    if (isUnreserved(c)) {
+      encoded += c;
+      continue;
+    }
+    auto byte = static_cast<unsigned char>(c);
+    encoded += '%';
+    encoded += kHex[byte >> 4];
+    encoded += kHex[byte & 0x0f];
+  }
+  return encoded;
+}
+
+} // namespace Url
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "cyclone/view.hpp"
+#include "../../app/helpers/application_helper.hpp"
+#include "output_buffer.hpp"
+#include "fragment_cache.hpp"
+#include <atomic>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Runtime support for views compiled ahead of time by tools/cyc_compile
+ *
+ * Each compiled template registers itself under its view name at static
+ * initialisation time. CompiledViews::Renderer is installed as the
+ * application's view renderer and serves those names; anything else
+ * (engine views, templates without a locals directive) returns std::nullopt
+ * and falls through to the cyclone-views interpreter.
+ *
+ * renderCollection() resolves a partial once and renders every item of a
+ * collection into the same buffer, rebinding only the item variable.
+ */
+
+namespace CompiledViews {
+
+using RenderFn = void (*)(Cyclone::ViewContext& context, OutputBuffer& out);
+using RenderEachFn = bool (*)(Cyclone::ViewContext& context, std::string_view as, const std::type_info& type,
+                              const void* items, OutputBuffer& out);
+
+struct Entry {
+  RenderFn render;
+  RenderEachFn renderEach;
+  // Size of the previous render, used to reserve the buffer up front
+  mutable std::atomic<size_t> sizeHint{4096};
+};
+
+class Registry {
+public:
+  static Registry& instance() {
+    static Registry registry;
+    return registry;
+  }
+
+  void add(std::string name, RenderFn render, RenderEachFn renderEach) {
+    auto& entry = entries_[std::move(name)];
+    entry.render = render;
+    entry.renderEach = renderEach;
+  }
+
+  const Entry* find(std::string_view name) const {
+    auto it = entries_.find(std::string(name));
+    return it == entries_.end() ? nullptr : &it->second;
+  }
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+struct Registration {
+  Registration(const char* name, RenderFn render, RenderEachFn renderEach) {
+    Registry::instance().add(name, render, renderEach);
+  }
+};
+
+// Render `partial` once per element of `items` into `out`, exposing each
+// element as the view variable `as`. Returns false when the partial was not
+// compiled (or does not declare `as` with a matching type) so callers can fall
+// back to the interpreter.
+template <typename T>
+bool renderCollection(std::string_view partial, const std::vector<T>& items, std::string_view as,
+                      Cyclone::ViewContext& context, OutputBuffer& out) {
+  const Entry* entry = Registry::instance().find(partial);
+  if (!entry || !entry->renderEach) {
+    return false;
+  }
+
+  size_t perItem = entry->sizeHint.load(std::memory_order_relaxed);
+  out.reserve(out.size() + perItem * items.size());
+
+  size_t start = out.size();
+  if (!entry->renderEach(context, as, typeid(std::vector<T>), &items, out)) {
+    return false;
+  }
+
+  if (!items.empty()) {
+    size_t average = (out.size() - start) / items.size();
+    entry->sizeHint.store(average + average / 8, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+// Helper scope that compiled templates run in, so that helper calls such as
+// formatDate() or loggedIn() resolve exactly as they do in the interpreter.
+class Scope : public ApplicationHelper {
+public:
+  Scope(Cyclone::ViewContext& context, OutputBuffer& out) : context_(context), out_(out) {
+    bind(context);
+  }
+
+  // Appends straight into the enclosing view's buffer; the returned empty
+  // markup keeps `<%= renderCollection(...) %>` valid template syntax.
+  template <typename T>
+  SafeHtml renderCollection(const std::string& partial, const std::vector<T>& items, const std::string& as) {
+    if (!CompiledViews::renderCollection(partial, items, as, context_, out_)) {
+      for (const auto& item : items) {
+        out_.append(renderPartial(partial, {{as, item}}));
+      }
+    }
+    return {};
+  }
+
+  // Helpers whose output is markup: `<%= %>` copies it without escaping.
+  // Every other string a template prints is HTML-escaped.
+  SafeHtml renderPartial(const std::string& partial, const Cyclone::ViewVars& vars) {
+    return {ApplicationHelper::renderPartial(partial, vars)};
+  }
+
+  SafeHtml seekPaginationLinks(const SeekPagination& pagination, const std::string& path) {
+    return {ApplicationHelper::seekPaginationLinks(pagination, path)};
+  }
+
+  SafeHtml markdown(const std::string& content) {
+    return {ApplicationHelper::markdown(content)};
+  }
+
+  template <typename... Args>
+  SafeHtml yield(Args&&... args) {
+    return {ApplicationHelper::yield(std::forward<Args>(args)...)};
+  }
+
+private:
+  Cyclone::ViewContext& context_;
+  OutputBuffer& out_;
+};
+
+// Resolve one view variable for the Locals struct. Missing variables bind to a
+// default-constructed value, mirroring the interpreter's falsy lookups.
+template <typename T>
+const T& bindVar(const Cyclone::ViewVars& vars, const char* name) {
+  if (const T* value = vars.find<T>(name)) {
+    return *value;
+  }
+  static const T empty{};
+  return empty;
+}
+
+inline std::optional<std::string> render(std::string_view name, Cyclone::ViewContext& context) {
+  const Entry* entry = Registry::instance().find(name);
+  if (!entry) {
+    return std::nullopt;
+  }
+
+  OutputBuffer out(entry->sizeHint.load(std::memory_order_relaxed));
+  entry->render(context, out);
+  entry->sizeHint.store(out.size() + out.size() / 8, std::memory_order_relaxed);
+
+  return out.release();
+}
+
+class Renderer : public Cyclone::ViewRenderer {
+public:
+  std::optional<std::string> render(const std::string& name, Cyclone::ViewContext& context) override {
+    return CompiledViews::render(name, context);
+  }
+};
+
+} // namespace CompiledViews
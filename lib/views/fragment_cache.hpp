@@ -0,0 +1,76 @@
+#pragma once
+
+#include "cyclone/cache.hpp"
+#include "output_buffer.hpp"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace CompiledViews {
+
+/**
+ * Fragment caching for compiled views
+ *
+ *   <% cache(post, post.user()) { %> ... <% } %>
+ *
+ * The key combines the template name, line and source digest with each part's
+ * cache key. Models contribute `table/id-updated_at`, so saving a model (or
+ * touching it from a child, see Touching<>) retires its fragments without any
+ * explicit expiry. Nested blocks keyed on children keep hitting after the
+ * parent fragment is rebuilt (Russian-doll caching).
+ */
+
+// How long unused fragments may linger before the store drops them
+inline constexpr std::chrono::hours kFragmentTtl{24};
+
+template <typename T>
+void appendCacheKey(std::string& key, const T& part) {
+  if constexpr (requires { T::tableName(); part.id(); part.updatedAt(); }) {
+    auto updatedAt = std::chrono::duration_cast<std::chrono::microseconds>(
+      part.updatedAt().time_since_epoch()).count();
+
+    key += T::tableName();
+    key += '/';
+    key += std::to_string(part.id());
+    key += '-';
+    key += std::to_string(updatedAt);
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    key += std::to_string(part);
+  } else {
+    key += std::string_view(part);
+  }
+}
+
+class Fragment {
+public:
+  template <typename... Parts>
+  Fragment(OutputBuffer& out, std::string_view templateKey, const Parts&... parts) {
+    key_.reserve(64);
+    key_ = "views/";
+    key_ += templateKey;
+    ((key_ += '/', appendCacheKey(key_, parts)), ...);
+
+    if (auto cached = Cyclone::Cache::read(key_)) {
+      out.append(*cached);
+      hit_ = true;
+    } else {
+      start_ = out.size();
+    }
+  }
+
+  bool hit() const { return hit_; }
+
+  // Called at the end of the block on a miss
+  void store(const OutputBuffer& out) {
+    Cyclone::Cache::write(key_, std::string(out.view(start_)), kFragmentTtl);
+  }
+
+private:
+  std::string key_;
+  size_t start_ = 0;
+  bool hit_ = false;
+};
+
+} // namespace CompiledViews
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Html {
+
+// Append `text` to `out` with &, <, >, " and ' replaced by entities, so it is
+// safe both as element content and inside a quoted attribute
+inline void escapeInto(std::string& out, std::string_view text) {
+  size_t start = 0;
+  for (size_t i = 0; i < text.size(); i++) {
+    const char* entity = nullptr;
+    switch (text[i]) {
+      case '&': entity = "&amp;"; break;
+      case '<': entity = "&lt;"; break;
+      case '>': entity = "&gt;"; break;
+      case '"': entity = "&quot;"; break;
+      case '\'': entity = "&#39;"; break;
+      default: continue;
+    }
+    out.append(text, start, i - start);
+    out.append(entity);
+    start = i + 1;
+  }
+  out.append(text, start, text.size() - start);
+}
+
+inline std::string escape(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  escapeInto(out, text);
+  return out;
+}
+
+} // namespace Html
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "html_escape.hpp"
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace CompiledViews {
+
+/**
+ * Growable output buffer used by compiled views
+ *
+ * Templates append static chunks and expression results directly, so a render
+ * performs no intermediate string allocations beyond the buffer's own growth.
+ *
+ * `<%= expr %>` compiles to appendEscaped(), which HTML-escapes text. Only
+ * SafeHtml, returned by the helpers that produce markup (renderPartial,
+ * renderCollection, seekPaginationLinks, markdown, yield), is copied as is.
+ */
+
+// Markup that is already HTML and must not be escaped again
+struct SafeHtml {
+  std::string html;
+};
+
+class OutputBuffer {
+public:
+  explicit OutputBuffer(size_t capacity = 0) {
+    data_.reserve(capacity);
+  }
+
+  void append(std::string_view text) {
+    data_.append(text);
+  }
+
+  void append(const std::string& text) {
+    data_.append(text);
+  }
+
+  void append(const char* text) {
+    if (text) data_.append(text);
+  }
+
+  void append(char c) {
+    data_.push_back(c);
+  }
+
+  void append(bool value) {
+    data_.append(value ? "true" : "false");
+  }
+
+  void append(const SafeHtml& markup) {
+    data_.append(markup.html);
+  }
+
+  template <typename T>
+    requires std::is_arithmetic_v<T>
+  void append(T value) {
+    char digits[32];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    data_.append(digits, end);
+  }
+
+  // Anything else that knows how to print itself (TimePoint, Json, ...)
+  template <typename T>
+    requires (!std::is_arithmetic_v<T>) && requires(const T& v) { { v.toString() } -> std::convertible_to<std::string>; }
+  void append(const T& value) {
+    data_.append(value.toString());
+  }
+
+  // append() with text HTML-escaped; numbers, bools and SafeHtml unchanged
+  template <typename T>
+  void appendEscaped(const T& value) {
+    if constexpr (std::is_same_v<T, char>) {
+      Html::escapeInto(data_, std::string_view(&value, 1));
+    } else if constexpr (std::is_convertible_v<const T&, const char*>) {
+      if (const char* text = value) Html::escapeInto(data_, text);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      Html::escapeInto(data_, std::string_view(value));
+    } else if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, SafeHtml>) {
+      append(value);
+    } else {
+      Html::escapeInto(data_, value.toString());
+    }
+  }
+
+  void reserve(size_t capacity) {
+    data_.reserve(capacity);
+  }
+
+  size_t size() const { return data_.size(); }
+  std::string_view view() const { return data_; }
+  std::string_view view(size_t from) const { return std::string_view(data_).substr(from); }
+
+  std::string release() { return std::move(data_); }
+
+private:
+  std::string data_;
+};
+
+} // namespace CompiledViews
@@ -81,6 +81,33 @@ public:
     return posts;
   }
 
+  /**
+   * Insert many Posts in multi-row statements, skipping validations and
+   * callbacks; for large fixtures where the models themselves are not needed
+   *
+   * @param count Number of posts to insert
+   * @param attributes Attributes to apply to all posts (user_id is required)
+   * @return Number of rows inserted
+   */
+  static size_t insertMany(int count, std::map<std::string, std::any> attributes) {
+    std::vector<std::map<std::string, std::any>> rows;
+    rows.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+      std::map<std::string, std::any> row = {
+        {"title", "Bulk Post " + std::to_string(i + 1)},
+        {"content", generateLoremIpsum(1, 3)},
+        {"published", false}
+      };
+      for (const auto& [key, value] : attributes) {
+        row[key] = value;
+      }
+      rows.push_back(std::move(row));
+    }
+
+    return Post::insertAll(std::move(rows), {.validate = false}).written;
+  }
+
   /**
    * Create multiple Posts for the same user
    *
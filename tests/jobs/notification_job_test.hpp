@@ -3,7 +3,10 @@
 #include "test_framework.hpp"
 #include "../../app/jobs/notification_job.hpp"
 #include "../../app/services/mailer_service_mock.hpp"
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 class NotificationJobTest : public TestCase {
 public:
@@ -218,12 +221,197 @@ public:
     });
   }
 
+  void describe_digest_notifications() {
+    describe("when notifications are coalesced into a digest", [&]() {
+      it("opens one window per recipient and type", [&]() {
+        auto type = static_cast<int>(NotificationJob::Type::NewLike);
+
+        expect(NotificationDigest::add(testUser->id(), type, sourceUser->id(), testPost->id(), 0)).to_be_true();
+        expect(NotificationDigest::add(testUser->id(), type, sourceUser->id(), 0, testComment->id())).to_be_false();
+
+        auto events = NotificationDigest::take(testUser->id(), type);
+        expect(events.size()).to_equal(2);
+        expect(events[0].postId).to_equal(testPost->id());
+        expect(events[1].commentId).to_equal(testComment->id());
+
+        // Taking closes the window and drains it
+        expect(NotificationDigest::take(testUser->id(), type).size()).to_equal(0);
+        expect(NotificationDigest::add(testUser->id(), type, sourceUser->id(), testPost->id(), 0)).to_be_true();
+        NotificationDigest::take(testUser->id(), type);
+      });
+
+      it("records a batch of events and reports each window it opened once", [&]() {
+        auto comment = static_cast<int>(NotificationJob::Type::NewComment);
+        auto mention = static_cast<int>(NotificationJob::Type::MentionedInComment);
+        std::vector<NotificationDigest::Event> events = {
+          {testUser->id(), comment, sourceUser->id(), testPost->id(), testComment->id()},
+          {testUser->id(), mention, sourceUser->id(), testPost->id(), testComment->id()},
+          {sourceUser->id(), mention, testUser->id(), testPost->id(), testComment->id()},
+          {testUser->id(), mention, sourceUser->id(), testPost->id(), testComment->id()}
+        };
+
+        expect(NotificationDigest::addAll(events).size()).to_equal(3);
+        expect(NotificationDigest::addAll(events).size()).to_equal(0);
+
+        expect(NotificationDigest::take(testUser->id(), mention).size()).to_equal(4);
+        NotificationDigest::take(testUser->id(), comment);
+        NotificationDigest::take(sourceUser->id(), mention);
+      });
+
+      it("sends one email for every event in the window", [&]() {
+        auto type = NotificationJob::Type::NewLike;
+        NotificationDigest::add(testUser->id(), static_cast<int>(type), sourceUser->id(), testPost->id(), 0);
+        NotificationDigest::add(testUser->id(), static_cast<int>(type), sourceUser->id(), 0, testComment->id());
+
+        NotificationJob job({.type = type, .user_id = testUser->id(), .source_user_id = 0, .digest = true});
+        job.perform();
+
+        expect(mailerMock->sentEmails.size()).to_equal(1);
+
+        const auto& email = mailerMock->sentEmails[0];
+        expect(email.recipient).to_equal(testUser->email());
+        expect(email.subject).to_equal("2 new likes on your content");
+        expect(email.templateName).to_equal("like_digest_notification");
+        expect(email.templateData.at("count")).to_equal("2");
+        expect(email.templateData.at("actors")).to_equal(sourceUser->name());
+        expect(email.templateData.at("items")).to_contain("liked your post");
+        expect(email.templateData.at("url")).to_contain("#comment-" + std::to_string(testComment->id()));
+      });
+
+      it("sends the regular email for a lone event", [&]() {
+        auto type = NotificationJob::Type::MentionedInComment;
+        NotificationDigest::add(testUser->id(), static_cast<int>(type), sourceUser->id(), testPost->id(), testComment->id());
+
+        NotificationJob job({.type = type, .user_id = testUser->id(), .source_user_id = 0, .digest = true});
+        job.perform();
+
+        expect(mailerMock->sentEmails.size()).to_equal(1);
+        expect(mailerMock->sentEmails[0].templateName).to_equal("mention_notification");
+      });
+
+      it("puts the events back when the digest cannot be sent", [&]() {
+        auto type = NotificationJob::Type::NewLike;
+        NotificationDigest::add(testUser->id(), static_cast<int>(type), sourceUser->id(), testPost->id(), 0);
+        NotificationDigest::add(testUser->id(), static_cast<int>(type), sourceUser->id(), 0, testComment->id());
+        Jobs::Outbox::relay(1000);
+        mailerMock->failTemplates = true;
+
+        NotificationJob job({.type = type, .user_id = testUser->id(), .source_user_id = 0, .digest = true});
+        bool raised = false;
+        try {
+          job.perform();
+        } catch (const std::runtime_error&) {
+          raised = true;
+        }
+
+        // Back in a new window, with a digest job of its own
+        expect(raised).to_be_true();
+        expect(outboxSize()).to_equal(1);
+        expect(NotificationDigest::take(testUser->id(), static_cast<int>(type)).size()).to_equal(2);
+        Jobs::Outbox::relay(1000);
+      });
+
+      it("reschedules a window whose digest job was lost", [&]() {
+        auto type = static_cast<int>(NotificationJob::Type::NewLike);
+        Jobs::Outbox::relay(1000);
+
+        NotificationDigest::add(testUser->id(), type, sourceUser->id(), testPost->id(), 0);
+        Cyclone::Database::execute(
+          "UPDATE notification_windows SET flush_at = ? WHERE user_id = ? AND type = ?",
+          {TimePoint::now() - std::chrono::hours(1), testUser->id(), type}
+        );
+
+        expect(NotificationDigest::sweep(std::chrono::minutes(5), &NotificationJob::resumeDigests)).to_equal(1);
+        expect(outboxSize()).to_equal(1);
+
+        // flush_at moved on, so the next sweep leaves it to the new job
+        expect(NotificationDigest::sweep(std::chrono::minutes(5), &NotificationJob::resumeDigests)).to_equal(0);
+
+        Jobs::Outbox::relay(1000);
+        NotificationDigest::take(testUser->id(), type);
+      });
+
+      it("sends nothing when the window was already drained", [&]() {
+        NotificationJob job({.type = NotificationJob::Type::NewComment, .user_id = testUser->id(),
+                             .source_user_id = 0, .digest = true});
+        job.perform();
+
+        expect(mailerMock->sentEmails.size()).to_equal(0);
+      });
+    });
+  }
+
+  void describe_outbox() {
+    describe("when notifying inside a transaction", [&]() {
+      it("writes the job to the outbox and relays it after the commit", [&]() {
+        Jobs::Outbox::relay(1000);
+
+        Cyclone::Database::transaction([&]() {
+          NotificationJob::notify(publishedParams());
+        });
+        expect(outboxSize()).to_equal(1);
+
+        expect(Jobs::Outbox::relay(1000)).to_equal(1);
+        expect(outboxSize()).to_equal(0);
+      });
+
+      it("commits a digest job with the window it opens", [&]() {
+        Jobs::Outbox::relay(1000);
+
+        NotificationJob::Params like = publishedParams();
+        like.type = NotificationJob::Type::NewLike;
+        NotificationJob::notify(like);
+
+        expect(outboxSize()).to_equal(1);
+        expect(Cyclone::Database::scalar<int>(
+          "SELECT COUNT(*) FROM notification_windows WHERE user_id = ?", {testUser->id()})).to_equal(1);
+
+        Jobs::Outbox::relay(1000);
+        NotificationDigest::take(testUser->id(), static_cast<int>(like.type));
+      });
+
+      it("relays past rows it cannot deliver", [&]() {
+        Jobs::Outbox::relay(1000);
+
+        auto insert = "INSERT INTO job_outbox (job, params, available_at) VALUES (?, ?, ?)";
+        Cyclone::Database::execute(insert, {std::string("retired_job"), std::vector<std::byte>{std::byte{1}}, TimePoint::now()});
+        Cyclone::Database::execute(insert, {std::string(NotificationJob::kOutboxName),
+                                            std::vector<std::byte>{std::byte{0xff}}, TimePoint::now()});
+        Cyclone::Database::transaction([&]() {
+          NotificationJob::notify(publishedParams());
+        });
+
+        // The undecodable row is dropped, the unknown one left for whoever knows it
+        expect_logs([&]() {
+          expect(Jobs::Outbox::relay(1000)).to_equal(2);
+        }).to_contain("dropping undecodable notification");
+        expect(outboxSize()).to_equal(1);
+
+        Cyclone::Database::execute("DELETE FROM job_outbox WHERE job = ?", {std::string("retired_job")});
+      });
+
+      it("drops the job when the transaction rolls back", [&]() {
+        try {
+          Cyclone::Database::transaction([&]() {
+            NotificationJob::notify(publishedParams());
+            throw std::runtime_error("rollback");
+          });
+        } catch (const std::runtime_error&) {
+        }
+
+        expect(outboxSize()).to_equal(0);
+      });
+    });
+  }
+
   void run_tests() override {
     describe_new_comment_notification();
     describe_new_like_notification();
     describe_mention_notification();
     describe_post_published_notification();
     describe_metrics_recording();
+    describe_digest_notifications();
+    describe_outbox();
   }
 
 private:
@@ -233,6 +421,19 @@ private:
   std::shared_ptr<Post> testPost;
   std::shared_ptr<Comment> testComment;
 
+  NotificationJob::Params publishedParams() {
+    NotificationJob::Params params;
+    params.type = NotificationJob::Type::PostPublished;
+    params.user_id = testUser->id();
+    params.source_user_id = sourceUser->id();
+    params.post_id = testPost->id();
+    return params;
+  }
+
+  int outboxSize() {
+    return Cyclone::Database::scalar<int>("SELECT COUNT(*) FROM job_outbox", {});
+  }
+
   std::shared_ptr<User> createTestUser(const std::string& email, const std::string& name) {
     auto user = std::make_shared<User>();
     user->setEmail(email);
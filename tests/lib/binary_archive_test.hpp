@@ -0,0 +1,150 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/jobs/binary_archive.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+class BinaryArchiveTest : public TestCase {
+public:
+  enum class Kind { First, Second, Seventh = 7 };
+
+  // Version 1 of a job's Params
+  struct ParamsV1 {
+    Kind kind = Kind::First;
+    int count = 0;
+    int64_t offset = 0;
+    bool urgent = false;
+    std::string label;
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+      ar & kind;
+      ar & count;
+      ar & offset;
+      ar & urgent;
+      ar & label;
+    }
+  };
+
+  // Version 2 appends two fields
+  struct ParamsV2 {
+    Kind kind = Kind::First;
+    int count = 0;
+    int64_t offset = 0;
+    bool urgent = false;
+    std::string label;
+    uint32_t retries = 3;
+    std::string_view note = "none";
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+      ar & kind;
+      ar & count;
+      ar & offset;
+      ar & urgent;
+      ar & label;
+      ar & retries;
+      ar & note;
+    }
+  };
+
+  void describe_round_trip() {
+    describe("encode and decode", [&]() {
+      it("round-trips every field", [&]() {
+        auto copy = Jobs::decode<ParamsV1>(Jobs::encode(ParamsV1{Kind::Seventh, 300, 1234567890123, true, "héllo"}));
+
+        expect(copy.kind == Kind::Seventh).to_be_true();
+        expect(copy.count).to_equal(300);
+        expect(copy.offset == 1234567890123).to_be_true();
+        expect(copy.urgent).to_be_true();
+        expect(copy.label).to_equal("héllo");
+      });
+
+      it("keeps negative and extreme values", [&]() {
+        auto copy = Jobs::decode<ParamsV1>(Jobs::encode(ParamsV1{Kind::First, -1, INT64_MIN, false, ""}));
+
+        expect(copy.count).to_equal(-1);
+        expect(copy.offset == INT64_MIN).to_be_true();
+        expect(copy.label.empty()).to_be_true();
+      });
+
+      it("writes small values in one byte each", [&]() {
+        // Version byte, then a key and a value byte per field
+        auto bytes = Jobs::encode(ParamsV1{Kind::Second, 5, -3, true, "ab"});
+
+        expect(bytes.size()).to_equal(1 + 2 * 4 + 2 + 2);
+        expect(static_cast<int>(bytes[0])).to_equal(static_cast<int>(Jobs::kArchiveVersion));
+      });
+    });
+  }
+
+  void describe_schema_evolution() {
+    describe("schema evolution", [&]() {
+      it("lets a newer reader keep defaults for fields an older writer lacks", [&]() {
+        auto copy = Jobs::decode<ParamsV2>(Jobs::encode(ParamsV1{Kind::Second, 7, 8, true, "old"}));
+
+        expect(copy.count).to_equal(7);
+        expect(copy.label).to_equal("old");
+        expect(copy.retries == 3u).to_be_true();
+        expect(std::string(copy.note)).to_equal("none");
+      });
+
+      it("lets an older reader skip fields it does not know", [&]() {
+        auto copy = Jobs::decode<ParamsV1>(Jobs::encode(ParamsV2{Kind::Second, 7, 8, true, "new", 9, "extra"}));
+
+        expect(copy.count).to_equal(7);
+        expect(copy.label).to_equal("new");
+      });
+
+      it("decodes string_view members without copying", [&]() {
+        auto bytes = Jobs::encode(ParamsV2{Kind::First, 1, 2, false, "x", 0, "in place"});
+        auto copy = Jobs::decode<ParamsV2>(bytes);
+
+        expect(std::string(copy.note)).to_equal("in place");
+        expect(copy.note.data() > bytes.data() && copy.note.data() < bytes.data() + bytes.size()).to_be_true();
+      });
+    });
+  }
+
+  void describe_malformed_input() {
+    describe("malformed input", [&]() {
+      it("rejects an unknown archive version", [&]() {
+        auto bytes = Jobs::encode(ParamsV1{});
+        bytes[0] = static_cast<char>(Jobs::kArchiveVersion + 1);
+
+        expect(throws([&]() { Jobs::decode<ParamsV1>(bytes); })).to_be_true();
+        expect(throws([&]() { Jobs::decode<ParamsV1>(""); })).to_be_true();
+      });
+
+      it("rejects a truncated string", [&]() {
+        auto bytes = Jobs::encode(ParamsV1{Kind::First, 1, 2, true, "truncated"});
+        bytes.resize(bytes.size() - 3);
+
+        expect(throws([&]() { Jobs::decode<ParamsV1>(bytes); })).to_be_true();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_round_trip();
+    describe_schema_evolution();
+    describe_malformed_input();
+  }
+
+private:
+  template <typename Fn>
+  static bool throws(Fn fn) {
+    try {
+      fn();
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(BinaryArchiveTest);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/views/output_buffer.hpp"
+#include "../factories/user_factory.hpp"
+#include "../factories/post_factory.hpp"
+#include "cyclone/testing/controller_test.hpp"
+#include <string>
+
+class CompiledViewTest : public cyclone::testing::ControllerTest {
+public:
+  void SetUp() override {
+    DatabaseCleaner::start();
+  }
+
+  void TearDown() override {
+    DatabaseCleaner::clean();
+  }
+
+  void describe_escaping() {
+    describe("<%= %> output", [&]() {
+      it("escapes text and leaves numbers and SafeHtml as they are", [&]() {
+        CompiledViews::OutputBuffer out;
+        out.appendEscaped(std::string("<a href=\"x\">Tom & 'Jerry'</a>"));
+        out.appendEscaped(42);
+        out.appendEscaped(CompiledViews::SafeHtml{"<br>"});
+
+        expect(std::string(out.view())).to_equal("&lt;a href=&quot;x&quot;&gt;Tom &amp; &#39;Jerry&#39;&lt;/a&gt;42<br>");
+      });
+
+      it("renders <script> in a local as text", [&]() {
+        auto post = PostFactory::createPublished({{"title", "<script>alert('title')</script>"}});
+        Comment::create({
+          {"user_id", UserFactory::create().id()},
+          {"post_id", post.id()},
+          {"content", "<script>alert('comment')</script>"}
+        });
+
+        auto response = get("/posts/" + std::to_string(post.id()));
+
+        expect(response.status).to_equal(200);
+        expect(response.body()).to_contain("&lt;script&gt;alert(&#39;title&#39;)&lt;/script&gt;");
+        expect(response.body()).to_contain("&lt;script&gt;alert(&#39;comment&#39;)&lt;/script&gt;");
+        expect(response.body().find("<script>alert(") == std::string::npos).to_be_true();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_escaping();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(CompiledViewTest);
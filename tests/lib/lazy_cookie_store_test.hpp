@@ -0,0 +1,56 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/session/lazy_cookie_store.hpp"
+#include <chrono>
+#include <string>
+
+class LazyCookieStoreTest : public TestCase {
+public:
+  void describe_max_age() {
+    describe("max_age", [&]() {
+      it("decodes a cookie signed within max_age", [&]() {
+        Sessions::LazyCookieSession session(cookieIssuedAt(now() - 60), kSecret, kMaxAge);
+
+        expect(session.find("user_id") != nullptr).to_be_true();
+      });
+
+      it("rejects a correctly signed cookie older than max_age", [&]() {
+        Sessions::LazyCookieSession session(cookieIssuedAt(now() - kMaxAge - 1), kSecret, kMaxAge);
+
+        expect(session.find("user_id") == nullptr).to_be_true();
+      });
+
+      it("rejects a cookie whose issue time was altered", [&]() {
+        auto cookie = cookieIssuedAt(now() - kMaxAge - 1);
+        cookie.replace(2, std::to_string(now()).size(), std::to_string(now()));
+        Sessions::LazyCookieSession session(cookie, kSecret, kMaxAge);
+
+        expect(session.find("user_id") == nullptr).to_be_true();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_max_age();
+  }
+
+private:
+  static constexpr int64_t kMaxAge = 3600;
+  inline static const std::string kSecret = "test-secret";
+
+  static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  // The cookie LazyCookieStore would have written at `issued`
+  static std::string cookieIssuedAt(int64_t issued) {
+    std::string signedPart = "-." + std::to_string(issued) + "." +
+                             Cyclone::Crypto::base64UrlEncode(R"({"user_id":7})");
+    return signedPart + "." + Cyclone::Crypto::base64UrlEncode(Cyclone::Crypto::hmacSha256(kSecret, signedPart));
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(LazyCookieStoreTest);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/text/mention_scanner.hpp"
+
+class MentionScannerTest : public TestCase {
+public:
+  void describe_scan() {
+    describe("scan", [&]() {
+      it("returns each name once, in order of appearance", [&]() {
+        auto names = Mentions::scan("thanks @alice and @bob_2, cc @alice");
+
+        expect(names.size()).to_equal(2);
+        expect(std::string(names[0])).to_equal("alice");
+        expect(std::string(names[1])).to_equal("bob_2");
+      });
+
+      it("stops names at the first non-name character", [&]() {
+        auto names = Mentions::scan("@carol's review, @dave.");
+
+        expect(names.size()).to_equal(2);
+        expect(std::string(names[0])).to_equal("carol");
+        expect(std::string(names[1])).to_equal("dave");
+      });
+
+      it("ignores a bare or doubled @", [&]() {
+        auto names = Mentions::scan("@ @@erin @");
+
+        expect(names.size()).to_equal(1);
+        expect(std::string(names[0])).to_equal("erin");
+      });
+
+      it("finds nothing in text without mentions", [&]() {
+        expect(Mentions::scan("no mentions here").empty()).to_be_true();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_scan();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(MentionScannerTest);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../app/models/post.hpp"
+#include "../factories/post_factory.hpp"
+#include <chrono>
+
+class RecordTest : public TestCase {
+public:
+  void describe_schema() {
+    describe("schema", [&]() {
+      it("lists columns in declaration order", [&]() {
+        constexpr auto columns = PostRow::columns();
+
+        expect(columns.size()).to_equal(10);
+        expect(std::string(columns[0])).to_equal("id");
+        expect(std::string(columns[2])).to_equal("title");
+      });
+
+      it("resolves member indices at compile time", [&]() {
+        static_assert(PostRow::indexOf<&PostRow::id>() == 0);
+        static_assert(PostRow::indexOf<&PostRow::likes_count>() == 7);
+
+        expect(PostRow::indexOf<&PostRow::title>()).to_equal(2);
+      });
+    });
+  }
+
+  void describe_changes() {
+    describe("dirty tracking", [&]() {
+      it("marks only the columns that were set", [&]() {
+        PostRow post;
+        expect(post.changed()).to_be_false();
+
+        post.set<&PostRow::title>(std::string("Renamed"));
+
+        expect(post.title).to_equal("Renamed");
+        expect(post.changed<&PostRow::title>()).to_be_true();
+        expect(post.changed<&PostRow::content>()).to_be_false();
+
+        post.clearChanges();
+        expect(post.changed()).to_be_false();
+      });
+
+      it("bumps updated_at when saving changes", [&]() {
+        auto created = PostFactory::create();
+        Cyclone::Database::execute("UPDATE posts SET updated_at = ? WHERE id = ?",
+                                   {TimePoint::now() - std::chrono::hours(1), created.id()});
+        auto post = PostRow::all(Post::where("id", created.id())).front();
+        auto before = *post.updated_at;
+
+        post.set<&PostRow::title>(std::string("Renamed"));
+        expect(post.saveChanges()).to_be_true();
+
+        auto saved = PostRow::all(Post::where("id", created.id())).front();
+        expect(saved.title).to_equal("Renamed");
+        expect(*saved.updated_at > before).to_be_true();
+      });
+    });
+  }
+
+  void describe_json() {
+    describe("toJson", [&]() {
+      it("emits every field, with null for empty optionals", [&]() {
+        PostRow post;
+        post.id = 7;
+        post.title = "Hello";
+
+        auto json = post.toJson();
+
+        expect(json["id"].get<int>()).to_equal(7);
+        expect(json["title"].get<std::string>()).to_equal("Hello");
+        expect(json["published_at"].is_null()).to_be_true();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_schema();
+    describe_changes();
+    describe_json();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(RecordTest);
\ No newline at end of file
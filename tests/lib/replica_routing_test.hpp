@@ -0,0 +1,49 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/database/replica_routing.hpp"
+#include <string>
+
+class ReplicaRoutingTest : public TestCase {
+public:
+  void describe_read_your_writes() {
+    describe("read-your-writes pin", [&]() {
+      it("pins the rest of a scope to the primary after a write", [&]() {
+        Replicas::Scope scope(false);
+
+        expect(std::string(Replicas::select(query(false)))).to_equal("default");
+        expect(scope.wrote()).to_be_true();
+        expect(std::string(Replicas::select(query(true)))).to_equal("default");
+      });
+
+      it("does not pin a thread that writes outside a scope", [&]() {
+        expect(std::string(Replicas::select(query(false)))).to_equal("default");
+
+        expect(Replicas::detail::state().wrote).to_be_false();
+      });
+
+      it("drops the pin when the scope closes", [&]() {
+        {
+          Replicas::Scope scope(false);
+          Replicas::select(query(false));
+        }
+
+        expect(Replicas::detail::state().wrote).to_be_false();
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_read_your_writes();
+  }
+
+private:
+  static Cyclone::Database::QueryContext query(bool readOnly) {
+    Cyclone::Database::QueryContext context;
+    context.readOnly = readOnly;
+    return context;
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(ReplicaRoutingTest);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/cache/sharded_memory_store.hpp"
+
+class ShardedMemoryStoreTest : public TestCase {
+public:
+  void describe_storage() {
+    describe("storage", [&]() {
+      it("rounds the shard count up to a power of two", [&]() {
+        Caching::ShardedMemoryStore store(Caching::StoreOptions{{"size_mb", "1"}, {"shards", "6"}});
+
+        expect(store.shardCount()).to_equal(8);
+      });
+
+      it("reads back written values until removed", [&]() {
+        Caching::ShardedMemoryStore store(Caching::StoreOptions{{"size_mb", "1"}});
+
+        store.write("greeting", "hello", std::chrono::seconds(0));
+        expect(store.read("greeting").value_or("")).to_equal("hello");
+
+        expect(store.remove("greeting")).to_be_true();
+        expect(store.read("greeting").has_value()).to_be_false();
+      });
+
+      it("rejects values larger than a shard", [&]() {
+        Caching::ShardedMemoryStore store(Caching::StoreOptions{{"size_mb", "1"}, {"shards", "4"}});
+
+        store.write("huge", std::string(512 * 1024, 'x'), std::chrono::seconds(0));
+        expect(store.read("huge").has_value()).to_be_false();
+      });
+    });
+  }
+
+  void describe_eviction() {
+    describe("eviction", [&]() {
+      it("stays within its byte budget", [&]() {
+        Caching::ShardedMemoryStore store(Caching::StoreOptions{{"size_mb", "1"}, {"shards", "4"}});
+
+        for (int i = 0; i < 10000; ++i) {
+          store.write("key" + std::to_string(i), std::string(400, 'x'), std::chrono::seconds(0));
+        }
+
+        uint64_t evictions = 0;
+        for (const auto& shard : store.stats()) {
+          expect(shard.bytes <= shard.capacity).to_be_true();
+          evictions += shard.evictions;
+        }
+        expect(evictions > 0).to_be_true();
+      });
+
+      it("keeps frequently read entries through a scan", [&]() {
+        Caching::ShardedMemoryStore store(Caching::StoreOptions{{"size_mb", "1"}, {"shards", "4"}});
+
+        for (int round = 0; round < 10; ++round) {
+          for (int i = 0; i < 100; ++i) {
+            auto key = "hot" + std::to_string(i);
+            if (!store.read(key)) {
+              store.write(key, std::string(400, 'h'), std::chrono::seconds(0));
+            }
+          }
+        }
+
+        for (int i = 0; i < 20000; ++i) {
+          auto key = "scan" + std::to_string(i);
+          if (!store.read(key)) {
+            store.write(key, std::string(400, 's'), std::chrono::seconds(0));
+          }
+        }
+
+        int survivors = 0;
+        for (int i = 0; i < 100; ++i) {
+          survivors += store.read("hot" + std::to_string(i)).has_value();
+        }
+        expect(survivors).to_equal(100);
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_storage();
+    describe_eviction();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(ShardedMemoryStoreTest);
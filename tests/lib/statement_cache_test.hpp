@@ -0,0 +1,37 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/database/statement_cache.hpp"
+#include <string>
+
+class StatementCacheTest : public TestCase {
+public:
+  void describe_normalize() {
+    describe("normalize", [&]() {
+      it("collapses whitespace between tokens", [&]() {
+        expect(Statements::normalize("  SELECT *\n  FROM posts\tWHERE id = ?  "))
+          .to_equal("SELECT * FROM posts WHERE id = ?");
+      });
+
+      it("leaves string literals and quoted identifiers alone", [&]() {
+        expect(Statements::normalize("SELECT 'a  b', \"c  d\", [e  f] FROM t"))
+          .to_equal("SELECT 'a  b', \"c  d\", [e  f] FROM t");
+      });
+
+      it("keys SQL with comments or backslashes as written", [&]() {
+        std::string comment = "SELECT id -- pick the id\nFROM posts";
+        std::string escaped = "SELECT E'it\\'s  here' FROM posts";
+
+        expect(Statements::normalize(comment)).to_equal(comment);
+        expect(Statements::normalize(escaped)).to_equal(escaped);
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_normalize();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(StatementCacheTest);
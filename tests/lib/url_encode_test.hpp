@@ -0,0 +1,30 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/text/url_encode.hpp"
+
+class UrlEncodeTest : public TestCase {
+public:
+  void describe_encode() {
+    describe("encode", [&]() {
+      it("leaves unreserved characters alone", [&]() {
+        expect(Url::encode("Post-1_a.b~c")).to_equal("Post-1_a.b~c");
+      });
+
+      it("encodes characters that would end the value or the query", [&]() {
+        expect(Url::encode("a&b=c #d?")).to_equal("a%26b%3Dc%20%23d%3F");
+      });
+
+      it("encodes each byte of UTF-8 text", [&]() {
+        expect(Url::encode("é")).to_equal("%C3%A9");
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_encode();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(UrlEncodeTest);
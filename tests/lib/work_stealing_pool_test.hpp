@@ -0,0 +1,138 @@
+#pragma once
+
+#include "test_framework.hpp"
+#include "../../lib/jobs/work_stealing_pool.hpp"
+#include <latch>
+
+class WorkStealingPoolTest : public TestCase {
+public:
+  void describe_deque() {
+    describe("Chase-Lev deque", [&]() {
+      it("pops newest first and steals oldest first", [&]() {
+        Jobs::ChaseLevDeque<int> deque(4);
+        int a = 1, b = 2, c = 3;
+        deque.push(&a);
+        deque.push(&b);
+        deque.push(&c);
+
+        expect(deque.steal() == &a).to_be_true();
+        expect(deque.pop() == &c).to_be_true();
+        expect(deque.pop() == &b).to_be_true();
+        expect(deque.pop() == nullptr).to_be_true();
+        expect(deque.empty()).to_be_true();
+      });
+
+      it("hands every item out exactly once under concurrent steals", [&]() {
+        Jobs::ChaseLevDeque<int> deque(64);
+        std::vector<int> values(50000, 1);
+        std::atomic<int> taken{0};
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> thieves;
+        for (int i = 0; i < 3; i++) {
+          thieves.emplace_back([&]() {
+            while (!done.load()) {
+              if (auto* value = deque.steal()) {
+                taken += *value;
+              }
+            }
+          });
+        }
+        for (auto& value : values) {
+          while (!deque.push(&value)) {
+            if (auto* popped = deque.pop()) {
+              taken += *popped;
+            }
+          }
+        }
+        while (auto* popped = deque.pop()) {
+          taken += *popped;
+        }
+        done = true;
+        for (auto& thief : thieves) {
+          thief.join();
+        }
+
+        expect(taken.load()).to_equal(50000);
+      });
+    });
+  }
+
+  void describe_scheduling() {
+    describe("scheduling", [&]() {
+      it("runs every submitted job before it is destroyed", [&]() {
+        std::atomic<int> ran{0};
+        {
+          Jobs::WorkStealingPool pool({.workers = 4, .queues = {{"mailers", 0}, {"default", 1}, {"reports", 2}}});
+          for (int i = 0; i < 10000; i++) {
+            pool.submit(i % 2 ? "reports" : "unknown", [&]() { ran++; });
+          }
+        }
+
+        expect(ran.load()).to_equal(10000);
+      });
+
+      it("runs batches handed over by Pulse", [&]() {
+        std::atomic<int> ran{0};
+        {
+          Jobs::WorkStealingPool pool({.workers = 4, .queues = {{"mailers", 0}, {"default", 1}}});
+          for (int batch = 0; batch < 100; batch++) {
+            std::vector<Jobs::WorkStealingPool::Task> tasks;
+            for (int i = 0; i < 64; i++) {
+              tasks.push_back([&]() { ran++; });
+            }
+            pool.submitBatch(batch % 2 ? "mailers" : "default", std::move(tasks));
+          }
+        }
+
+        expect(ran.load()).to_equal(6400);
+      });
+
+      it("runs higher lanes first", [&]() {
+        std::string order;
+        std::latch gate(1);
+        {
+          Jobs::WorkStealingPool pool({.workers = 1, .queues = {{"mailers", 0}, {"reports", 1}}, .batchSize = 1});
+          pool.submit("reports", [&]() { gate.wait(); });
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+          for (int i = 0; i < 3; i++) {
+            pool.submit("reports", [&]() { order += "r"; });
+          }
+          for (int i = 0; i < 3; i++) {
+            pool.submit("mailers", [&]() { order += "m"; });
+          }
+          gate.count_down();
+        }
+
+        expect(order).to_equal("mmmrrr");
+      });
+
+      it("shares a lane between its queues by weight", [&]() {
+        std::string order;
+        std::latch gate(1);
+        {
+          Jobs::WorkStealingPool pool({.workers = 1, .queues = {{"a", 0, 2}, {"b", 0, 1}, {"gate", 1}}, .batchSize = 1});
+          pool.submit("gate", [&]() { gate.wait(); });
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+          for (int i = 0; i < 12; i++) {
+            pool.submit("a", [&]() { order += "a"; });
+            pool.submit("b", [&]() { order += "b"; });
+          }
+          gate.count_down();
+        }
+
+        expect(std::count(order.begin(), order.begin() + 9, 'a')).to_equal(6);
+      });
+    });
+  }
+
+  void run_tests() override {
+    describe_deque();
+    describe_scheduling();
+  }
+};
+
+// Register the test case with the test runner
+REGISTER_TEST_CASE(WorkStealingPoolTest);
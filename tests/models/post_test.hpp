@@ -3,9 +3,14 @@
 #include "test_framework.hpp"
 #include "../../app/models/post.hpp"
 #include "../../app/models/user.hpp"
+#include "../../app/models/comment.hpp"
+#include "../../app/models/like.hpp"
 #include "../factories/user_factory.hpp"
 #include "../factories/post_factory.hpp"
 #include "../support/database_cleaner.hpp"
+#include "../../app/models/concerns/write_behind_counters.hpp"
+#include "database/batches.hpp"
+#include "database/projection.hpp"
 
 class PostTest : public TestCase {
 public:
@@ -150,6 +155,19 @@ public:
 
   void describe_callbacks() {
     describe("callbacks", [&]() {
+      it("keeps finds in an identity map scope in step with saves and destroys", [&]() {
+        auto post = PostFactory::create({{"title", "Mapped Post"}});
+        IdentityMap::Scope scope;
+
+        auto found = Post::find(post.id());
+        found->setTitle("Saved Title");
+        found->save();
+        expect(Post::find(post.id())->title()).to_equal("Saved Title");
+
+        found->destroy();
+        expect(Post::find(post.id()).has_value()).to_be_false();
+      });
+
       it("sets published_at when publishing a post", [&]() {
         auto user = UserFactory::create();
         auto post = PostFactory::create({
@@ -203,6 +221,34 @@ public:
         expect(relatedUser.id()).to_equal(user.id());
       });
 
+      it("stands in a placeholder author when the user row is gone", [&]() {
+        auto user = UserFactory::create();
+        auto post = PostFactory::create({
+          {"user_id", user.id()}
+        });
+        User::deleteAll("id = ?", {user.id()});
+
+        expect(post.user().name()).to_equal("Deleted user");
+
+        post.setPreloaded<User>("user", std::nullopt);
+        expect(post.user().name()).to_equal("Deleted user");
+      });
+
+      it("stands in a placeholder post for a comment whose post is gone", [&]() {
+        auto post = PostFactory::create();
+        auto comment = Comment::create({
+          {"user_id", UserFactory::create().id()},
+          {"post_id", post.id()},
+          {"content", "Orphaned comment"}
+        });
+        Post::deleteAll("id = ?", {post.id()});
+
+        expect(comment.post().title()).to_equal("Deleted post");
+
+        comment.setPreloaded<Post>("post", std::nullopt);
+        expect(comment.post().title()).to_equal("Deleted post");
+      });
+
       it("has many comments", [&]() {
         auto post = PostFactory::create();
 
@@ -262,6 +308,8 @@ public:
           {"content", "Comment 2"}
         });
 
+        // comments_count is maintained in the database by the Comment callbacks
+        post.reload();
         expect(post.commentCount()).to_equal(2);
       });
 
@@ -274,16 +322,250 @@ public:
         // Add some likes
         Like::create({
           {"user_id", UserFactory::create().id()},
-          {"post_id", post.id()}
+          {"likeable_id", post.id()},
+          {"likeable_type", "Post"}
         });
 
         Like::create({
           {"user_id", UserFactory::create().id()},
-          {"post_id", post.id()}
+          {"likeable_id", post.id()},
+          {"likeable_type", "Post"}
         });
 
+        post.reload();
         expect(post.likeCount()).to_equal(2);
       });
+
+      it("decrements counters when children are destroyed", [&]() {
+        auto post = PostFactory::create();
+
+        auto comment = Comment::create({
+          {"user_id", UserFactory::create().id()},
+          {"post_id", post.id()},
+          {"content", "Comment 1"}
+        });
+
+        auto like = Like::create({
+          {"user_id", UserFactory::create().id()},
+          {"likeable_id", post.id()},
+          {"likeable_type", "Post"}
+        });
+
+        comment.destroy();
+        like.destroy();
+
+        post.reload();
+        expect(post.commentCount()).to_equal(0);
+        expect(post.likeCount()).to_equal(0);
+      });
+
+      it("rebuilds counters from the child tables", [&]() {
+        auto post = PostFactory::create();
+
+        Comment::create({
+          {"user_id", UserFactory::create().id()},
+          {"post_id", post.id()},
+          {"content", "Comment 1"}
+        });
+
+        // Simulate drift, e.g. rows inserted behind the model's back
+        Cyclone::Database::execute("UPDATE posts SET comments_count = 0 WHERE id = ?", {post.id()});
+
+        CounterCache::rebuildAll();
+
+        post.reload();
+        expect(post.commentCount()).to_equal(1);
+      });
+    });
+  }
+
+  void describe_eager_loading() {
+    describe("eager loading", [&]() {
+      it("preloads authors and association counts", [&]() {
+        auto author = UserFactory::create();
+        auto post = PostFactory::createPublished({{"user_id", author.id()}});
+        PostFactory::createPublished();
+
+        Comment::create({
+          {"user_id", UserFactory::create().id()},
+          {"post_id", post.id()},
+          {"content", "Comment 1"}
+        });
+
+        Like::create({
+          {"user_id", UserFactory::create().id()},
+          {"likeable_id", post.id()},
+          {"likeable_type", "Post"}
+        });
+
+        auto posts = includes<User, Comment, Like>(Post::published().orderBy("id", "ASC"));
+
+        expect(posts.size()).to_equal(2);
+        expect(posts[0].isPreloaded("user")).to_be_true();
+        expect(posts[0].user().id()).to_equal(author.id());
+        expect(posts[0].commentCount()).to_equal(1);
+        expect(posts[0].likeCount()).to_equal(1);
+        expect(posts[1].commentCount()).to_equal(0);
+        expect(posts[1].likeCount()).to_equal(0);
+      });
+
+      it("leaves associations lazy when not included", [&]() {
+        PostFactory::createPublished();
+
+        auto posts = Post::published().get();
+
+        expect(posts[0].isPreloaded("user")).to_be_false();
+        expect(posts[0].preloadedCount("comments").has_value()).to_be_false();
+      });
+    });
+  }
+
+  void describe_bulk_writes() {
+    describe("bulk writes", [&]() {
+      it("inserts rows in batches", [&]() {
+        auto author = UserFactory::create();
+
+        std::vector<Post::Attributes> rows;
+        for (int i = 0; i < 25; i++) {
+          rows.push_back({
+            {"user_id", author.id()},
+            {"title", "Bulk " + std::to_string(i)},
+            {"content", "Bulk content"}
+          });
+        }
+
+        auto result = Post::insertAll(rows, {.batchSize = 10});
+
+        expect(result.written).to_equal(25);
+        expect(Post::where("user_id", author.id()).count()).to_equal(25);
+      });
+
+      it("drops invalid rows unless validation is skipped", [&]() {
+        auto author = UserFactory::create();
+        std::vector<Post::Attributes> rows = {
+          {{"user_id", author.id()}, {"title", "Valid title"}, {"content", "Content"}},
+          {{"user_id", author.id()}, {"title", "AB"}, {"content", "Content"}}
+        };
+
+        auto validated = Post::insertAll(rows);
+        expect(validated.written).to_equal(1);
+        expect(validated.invalid.size()).to_equal(1);
+        expect(validated.invalid[0]).to_equal(1);
+
+        auto unchecked = Post::insertAll(rows, {.validate = false});
+        expect(unchecked.written).to_equal(2);
+      });
+
+      it("likes a post once and keeps its counter", [&]() {
+        auto post = PostFactory::createPublished();
+        auto liker = UserFactory::create();
+
+        expect(Like::likeOnce(liker.id(), post.id(), "Post")).to_be_true();
+        expect(Like::likeOnce(liker.id(), post.id(), "Post")).to_be_false();
+
+        post.reload();
+        expect(post.likeCount()).to_equal(1);
+        expect(Like::forPost(post.id()).count()).to_equal(1);
+      });
+
+      it("updates colliding rows on upsert", [&]() {
+        auto user = UserFactory::create({{"email", "upsert@example.com"}, {"name", "Before"}});
+
+        auto result = User::upsertAll({
+          {{"email", "upsert@example.com"}, {"name", "After"}, {"encrypted_password", "x"}}
+        }, {"email"}, {.validate = false});
+
+        expect(result.written).to_equal(1);
+        expect(User::count()).to_equal(1);
+        user.reload();
+        expect(user.name()).to_equal("After");
+      });
+    });
+  }
+
+  void describe_batches() {
+    describe("batches", [&]() {
+      it("visits every row once, in id order", [&]() {
+        auto author = UserFactory::create();
+        PostFactory::insertMany(25, {{"user_id", author.id()}});
+
+        std::vector<size_t> sizes;
+        findInBatches(Post::where("user_id", author.id()), 10, [&](std::vector<Post>& posts) {
+          sizes.push_back(posts.size());
+        });
+
+        int previous = 0;
+        int visited = 0;
+        findEach(Post::where("user_id", author.id()), 10, [&](const Post& post) {
+          expect(post.id() > previous).to_be_true();
+          previous = post.id();
+          visited++;
+        });
+
+        expect(sizes).to_equal(std::vector<size_t>{10, 10, 5});
+        expect(visited).to_equal(25);
+      });
+
+      it("stops when the callback returns false", [&]() {
+        auto author = UserFactory::create();
+        PostFactory::insertMany(5, {{"user_id", author.id()}});
+
+        int visited = 0;
+        findEach(Post::where("user_id", author.id()), 2, [&](const Post&) {
+          return ++visited < 3;
+        }, {.strategy = Batches::Strategy::Keyset});
+
+        expect(visited).to_equal(3);
+      });
+    });
+  }
+
+  void describe_projections() {
+    describe("projections", [&]() {
+      it("plucks typed columns", [&]() {
+        auto author = UserFactory::create();
+        auto post = PostFactory::create({{"user_id", author.id()}, {"title", "Plucked"}});
+
+        auto rows = pluck<int, std::string>(Post::where("user_id", author.id()), "id", "title");
+
+        expect(rows.size()).to_equal(1);
+        expect(std::get<0>(rows[0])).to_equal(post.id());
+        expect(std::get<1>(rows[0])).to_equal("Plucked");
+        expect(pluck<int>(Post::where("user_id", author.id()), "id")).to_equal(std::vector<int>{post.id()});
+      });
+
+      it("selects rows into a struct", [&]() {
+        auto author = UserFactory::create({{"name", "Projected Author"}});
+        PostFactory::createMany(2, {{"user_id", author.id()}});
+
+        auto authors = select<UserOption>(User::join<Post>().groupBy("users.id"));
+
+        expect(authors.size()).to_equal(1);
+        expect(authors[0].id).to_equal(author.id());
+        expect(authors[0].name).to_equal("Projected Author");
+      });
+    });
+  }
+
+  void describe_write_behind_counters() {
+    describe("write-behind like counters", [&]() {
+      it("defers likes_count until the flush", [&]() {
+        auto post = PostFactory::createPublished();
+        auto liker = UserFactory::create();
+
+        WriteBehindCounters::start({.flushInterval = std::chrono::hours(1), .logPath = "tmp/test_like_counters.log"});
+
+        expect(Like::likeOnce(liker.id(), post.id(), "Post")).to_be_true();
+        post.reload();
+        expect(post.likeCount()).to_equal(0);
+        expect(Like::displayedCount("Post", post.id(), post.likeCount())).to_equal(1);
+
+        WriteBehindCounters::stop();
+
+        post.reload();
+        expect(post.likeCount()).to_equal(1);
+        expect(CounterCache::deferred()).to_be_false();
+      });
     });
   }
 
@@ -293,6 +575,11 @@ public:
     describe_callbacks();
     describe_relationships();
     describe_methods();
+    describe_eager_loading();
+    describe_bulk_writes();
+    describe_batches();
+    describe_projections();
+    describe_write_behind_counters();
   }
 };
 
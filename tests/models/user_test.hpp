@@ -301,10 +301,80 @@ public:
     });
   }
 
+  void describe_identity_map() {
+    describe("identity map", [&]() {
+      auto createUser = []() {
+        return User::create({
+          {"email", "mapped@example.com"},
+          {"password", "password123"},
+          {"password_confirmation", "password123"},
+          {"name", "Mapped User"}
+        });
+      };
+
+      it("serves repeated finds from memory within a scope", [&]() {
+        auto user = createUser();
+        IdentityMap::Scope scope;
+
+        expect(User::find(user.id())->name()).to_equal("Mapped User");
+
+        // Bypasses the model, so the mapped row is not refreshed
+        Cyclone::Database::execute("UPDATE users SET name = ? WHERE id = ?", {"Renamed", user.id()});
+        expect(User::find(user.id())->name()).to_equal("Mapped User");
+
+        IdentityMap::evict(User::tableName(), user.id());
+        expect(User::find(user.id())->name()).to_equal("Renamed");
+      });
+
+      it("reflects saves and destroys made through the model", [&]() {
+        auto user = createUser();
+        IdentityMap::Scope scope;
+
+        auto found = User::find(user.id());
+        found->setName("Saved Name");
+        found->save();
+        expect(User::find(user.id())->name()).to_equal("Saved Name");
+
+        found->destroy();
+        expect(User::find(user.id()).has_value()).to_be_false();
+      });
+
+      it("reads through to the database outside a scope", [&]() {
+        auto user = createUser();
+        User::find(user.id());
+
+        Cyclone::Database::execute("UPDATE users SET name = ? WHERE id = ?", {"Renamed", user.id()});
+        expect(User::find(user.id())->name()).to_equal("Renamed");
+      });
+    });
+  }
+
+  void describe_name_lookup() {
+    describe("cached name lookup", [&]() {
+      it("stops matching the old name after a rename", [&]() {
+        auto user = User::create({
+          {"email", "renamed@example.com"},
+          {"password", "password123"},
+          {"password_confirmation", "password123"},
+          {"name", "Old Name"}
+        });
+        expect(User::idsByName({"Old Name"}, true).size()).to_equal(1);
+
+        user.setName("New Name");
+        user.save();
+
+        expect(User::idsByName({"Old Name"}, true).empty()).to_be_true();
+        expect(User::idsByName({"New Name"}, true).at("New Name")).to_equal(user.id());
+      });
+    });
+  }
+
   void run_tests() override {
     describe_validations();
     describe_authentication();
     describe_authorization();
+    describe_identity_map();
+    describe_name_lookup();
   }
 };
 
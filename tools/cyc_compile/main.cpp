@@ -0,0 +1,561 @@
+// cyc_compile: ahead-of-time compiler for .cyc.html view templates
+//
+// Turns every template that declares its view variables with a
+//
+//   <%@ locals std::vector<Post> posts; User current_user %>
+//
+// directive into a C++ translation unit that appends straight into a
+// CompiledViews::OutputBuffer. Static HTML becomes constexpr string_views and
+// every `@name` becomes a typed member access on a Locals struct that is bound
+// once per render. Templates without a locals directive are skipped and keep
+// being rendered by the cyclone-views interpreter.
+//
+// `<%= expr %>` output is HTML-escaped unless `expr` is CompiledViews::SafeHtml,
+// which only the markup helpers return (renderPartial, renderCollection,
+// seekPaginationLinks, markdown, yield).
+//
+// Each unit also exports a renderEach() entry point used by renderCollection():
+// the Locals frame is bound once and only the item variable is rebound per
+// element, so a 500-comment page is one partial lookup and one buffer.
+//
+// Fragment caching: `<% cache(post, post.user()) { %> ... <% } %>` becomes a
+// CompiledViews::Fragment keyed on the template, its digest and each model's
+// table/id/updated_at. A hit copies the cached bytes into the buffer and
+// skips the block.
+//
+// Usage: cyc_compile --root app/views --out gen/views <template>...
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CompileError : std::runtime_error {
+  CompileError(const std::string& file, int line, const std::string& message)
+    : std::runtime_error(file + ":" + std::to_string(line) + ": " + message) {}
+};
+
+enum class SegmentKind {
+  Text,        // Static HTML
+  Code,        // <% ... %>
+  Expression,  // <%= ... %>
+  Directive,   // <%@ ... %>
+};
+
+struct Segment {
+  SegmentKind kind;
+  std::string body;
+  int line;
+};
+
+struct Local {
+  std::string type;
+  std::string name;
+};
+
+struct Template {
+  std::string path;  // Source path, used for #line directives
+  std::string name;  // View name as passed to render(), e.g. "posts/index"
+  std::string digest;  // Hash of the source, so edits invalidate cached fragments
+  std::vector<Segment> segments;
+  std::optional<std::vector<Local>> locals;
+};
+
+std::string trim(std::string_view s) {
+  size_t begin = 0;
+  size_t end = s.size();
+  while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) begin++;
+  while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) end--;
+  return std::string(s.substr(begin, end - begin));
+}
+
+bool isIdentifierChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+std::string fnv1a(std::string_view s) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : s) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+  return hex;
+}
+
+int countLines(std::string_view s) {
+  int lines = 0;
+  for (char c : s) {
+    if (c == '\n') lines++;
+  }
+  return lines;
+}
+
+std::vector<Segment> tokenize(const std::string& source, const std::string& path) {
+  std::vector<Segment> segments;
+  size_t pos = 0;
+  int line = 1;
+
+  while (pos < source.size()) {
+    size_t open = source.find("<%", pos);
+
+    if (open == std::string::npos) {
+      segments.push_back({SegmentKind::Text, source.substr(pos), line});
+      break;
+    }
+
+    if (open > pos) {
+      auto text = source.substr(pos, open - pos);
+      segments.push_back({SegmentKind::Text, text, line});
+      line += countLines(text);
+    }
+
+    size_t close = source.find("%>", open + 2);
+    if (close == std::string::npos) {
+      throw CompileError(path, line, "unterminated <% tag");
+    }
+
+    size_t bodyStart = open + 2;
+    SegmentKind kind = SegmentKind::Code;
+    bool comment = false;
+
+    if (bodyStart < close) {
+      switch (source[bodyStart]) {
+        case '=': kind = SegmentKind::Expression; bodyStart++; break;
+        case '@': kind = SegmentKind::Directive; bodyStart++; break;
+        case '#': comment = true; break;
+      }
+    }
+
+    auto body = source.substr(bodyStart, close - bodyStart);
+    if (!comment) {
+      segments.push_back({kind, body, line});
+    }
+
+    line += countLines(source.substr(open, close + 2 - open));
+    pos = close + 2;
+  }
+
+  return segments;
+}
+
+std::vector<Local> parseLocals(const std::string& declarations, const std::string& path, int line) {
+  std::vector<Local> locals;
+  std::stringstream stream(declarations);
+  std::string declaration;
+
+  while (std::getline(stream, declaration, ';')) {
+    declaration = trim(declaration);
+    if (declaration.empty()) continue;
+
+    size_t nameStart = declaration.size();
+    while (nameStart > 0 && isIdentifierChar(declaration[nameStart - 1])) nameStart--;
+
+    auto name = declaration.substr(nameStart);
+    auto type = trim(std::string_view(declaration).substr(0, nameStart));
+
+    if (name.empty() || type.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+      throw CompileError(path, line, "malformed locals declaration '" + declaration + "'");
+    }
+
+    locals.push_back({type, name});
+  }
+
+  return locals;
+}
+
+Template parseTemplate(const fs::path& file, const fs::path& root) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("cannot read " + file.string());
+  }
+
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+
+  Template tmpl;
+  tmpl.path = file.generic_string();
+
+  auto relative = fs::relative(file, root).generic_string();
+  const std::string suffix = ".cyc.html";
+  if (relative.size() <= suffix.size() || relative.compare(relative.size() - suffix.size(), suffix.size(), suffix) != 0) {
+    throw std::runtime_error(tmpl.path + " is not a .cyc.html template");
+  }
+  tmpl.name = relative.substr(0, relative.size() - suffix.size());
+  tmpl.digest = fnv1a(buffer.str());
+
+  bool stripNewline = false;
+
+  for (auto& segment : tokenize(buffer.str(), tmpl.path)) {
+    if (segment.kind != SegmentKind::Directive) {
+      // A directive on its own line should not leave a blank line behind
+      if (stripNewline && segment.kind == SegmentKind::Text && !segment.body.empty() && segment.body[0] == '\n') {
+        segment.body.erase(0, 1);
+        segment.line++;
+      }
+      stripNewline = false;
+      tmpl.segments.push_back(std::move(segment));
+      continue;
+    }
+
+    stripNewline = true;
+
+    auto directive = trim(segment.body);
+    if (directive.rfind("locals", 0) == 0) {
+      tmpl.locals = parseLocals(directive.substr(6), tmpl.path, segment.line);
+    } else {
+      throw CompileError(tmpl.path, segment.line, "unknown directive '" + directive + "'");
+    }
+  }
+
+  return tmpl;
+}
+
+// Rewrite `@name` into a typed access on the bound Locals, leaving string and
+// character literals untouched.
+std::string translateCode(const std::string& code, const Template& tmpl, int line) {
+  std::string result;
+  result.reserve(code.size() + 32);
+
+  for (size_t i = 0; i < code.size(); i++) {
+    char c = code[i];
+
+    if (c == '"' || c == '\'') {
+      char quote = c;
+      result += c;
+      for (i++; i < code.size(); i++) {
+        result += code[i];
+        if (code[i] == '\\' && i + 1 < code.size()) {
+          result += code[++i];
+        } else if (code[i] == quote) {
+          break;
+        }
+      }
+      continue;
+    }
+
+    if (c == '\n') {
+      line++;
+    }
+
+    if (c == '@' && i + 1 < code.size() && (std::isalpha(static_cast<unsigned char>(code[i + 1])) || code[i + 1] == '_')) {
+      size_t end = i + 1;
+      while (end < code.size() && isIdentifierChar(code[end])) end++;
+      auto name = code.substr(i + 1, end - i - 1);
+
+      bool declared = false;
+      for (const auto& local : *tmpl.locals) {
+        if (local.name == name) declared = true;
+      }
+      if (!declared) {
+        throw CompileError(tmpl.path, line, "view variable @" + name + " is not declared in <%@ locals %>");
+      }
+
+      result += "(*locals." + name + ")";
+      i = end - 1;
+      continue;
+    }
+
+    result += c;
+  }
+
+  return result;
+}
+
+std::string cppStringLiteral(std::string_view text) {
+  std::string literal = "\"";
+  for (unsigned char c : text) {
+    switch (c) {
+      case '\\': literal += "\\\\"; break;
+      case '"': literal += "\\\""; break;
+      case '\n': literal += "\\n\"\n    \""; break;
+      case '\t': literal += "\\t"; break;
+      case '\r': literal += "\\r"; break;
+      case '?': literal += "\\?"; break;  // Avoid trigraphs
+      default:
+        if (c < 0x20 || c >= 0x7f) {
+          char escaped[5];
+          std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+          literal += escaped;
+        } else {
+          literal += static_cast<char>(c);
+        }
+    }
+  }
+  literal += "\"";
+  return literal;
+}
+
+std::string identifierFor(const std::string& viewName) {
+  std::string id = "view_";
+  for (char c : viewName) {
+    id += isIdentifierChar(c) ? c : '_';
+  }
+  return id;
+}
+
+// `cache(a, b) {` -> the argument list "a, b"; std::nullopt for other code
+std::optional<std::string> cacheArguments(const std::string& code) {
+  if (code.rfind("cache(", 0) != 0 || code.back() != '{') {
+    return std::nullopt;
+  }
+
+  int parens = 0;
+  for (size_t i = 5; i < code.size(); i++) {
+    if (code[i] == '(') parens++;
+    if (code[i] == ')' && --parens == 0) {
+      if (trim(std::string_view(code).substr(i + 1)) != "{") return std::nullopt;
+      return trim(std::string_view(code).substr(6, i - 6));
+    }
+  }
+  return std::nullopt;
+}
+
+struct OpenFragment {
+  int depth;         // Brace depth outside the cache block
+  std::string name;  // Local Fragment variable
+};
+
+// Insert the fragment store before any `}` that closes an open cache block
+std::string closeFragments(const std::string& code, int& depth, std::vector<OpenFragment>& open) {
+  std::string result;
+
+  for (size_t i = 0; i < code.size(); i++) {
+    char c = code[i];
+
+    if (c == '"' || c == '\'') {
+      char quote = c;
+      result += c;
+      for (i++; i < code.size(); i++) {
+        result += code[i];
+        if (code[i] == '\\' && i + 1 < code.size()) {
+          result += code[++i];
+        } else if (code[i] == quote) {
+          break;
+        }
+      }
+      continue;
+    }
+
+    if (c == '{') {
+      depth++;
+    } else if (c == '}') {
+      depth--;
+      if (!open.empty() && open.back().depth == depth) {
+        result += open.back().name + ".store(out); } ";
+        open.pop_back();
+      }
+    }
+
+    result += c;
+  }
+
+  return result;
+}
+
+std::string generate(const Template& tmpl) {
+  std::ostringstream chunks;
+  std::ostringstream body;
+  int chunkCount = 0;
+  int depth = 0;
+  std::vector<OpenFragment> openFragments;
+
+  for (const auto& segment : tmpl.segments) {
+    switch (segment.kind) {
+      case SegmentKind::Text:
+        if (segment.body.empty()) break;
+        chunks << "constexpr std::string_view chunk" << chunkCount << " =\n    "
+               << cppStringLiteral(segment.body) << ";\n\n";
+        body << "    out.append(chunk" << chunkCount++ << ");\n";
+        break;
+
+      case SegmentKind::Code: {
+        auto code = trim(translateCode(segment.body, tmpl, segment.line));
+        if (code.empty()) break;
+
+        if (auto arguments = cacheArguments(code)) {
+          auto name = "fragment" + std::to_string(segment.line);
+          auto key = tmpl.name + ":" + std::to_string(segment.line) + ":" + tmpl.digest;
+
+          body << "#line " << segment.line << " \"" << tmpl.path << "\"\n"
+               << "    { Fragment " << name << "(out, \"" << key << "\", " << *arguments << "); "
+               << "if (!" << name << ".hit()) {\n";
+
+          openFragments.push_back({depth, name});
+          depth++;
+          break;
+        }
+
+        code = closeFragments(code, depth, openFragments);
+
+        // `<% setTitle("About") %>` is a statement without its semicolon
+        char last = code.back();
+        if (last != '{' && last != '}' && last != ';' && last != ':') {
+          code += ';';
+        }
+
+        body << "#line " << segment.line << " \"" << tmpl.path << "\"\n"
+             << "    " << code << "\n";
+        break;
+      }
+
+      case SegmentKind::Expression:
+        body << "#line " << segment.line << " \"" << tmpl.path << "\"\n"
+             << "    out.appendEscaped(" << trim(translateCode(segment.body, tmpl, segment.line)) << ");\n";
+        break;
+
+      case SegmentKind::Directive:
+        break;
+    }
+  }
+
+  if (!openFragments.empty()) {
+    throw CompileError(tmpl.path, 0, "unterminated cache block (" + openFragments.back().name + ")");
+  }
+
+  auto ns = identifierFor(tmpl.name);
+  std::ostringstream out;
+
+  out << "// Generated by cyc_compile from " << tmpl.path << ". Do not edit.\n\n"
+      << "#include \"views/compiled_view.hpp\"\n\n"
+      << "namespace CompiledViews::" << ns << " {\n\n"
+      << "struct Locals {\n";
+  for (const auto& local : *tmpl.locals) {
+    out << "  const " << local.type << "* " << local.name << " = nullptr;\n";
+  }
+  out << "\n"
+      << "  static Locals bind(const Cyclone::ViewVars& vars) {\n"
+      << "    Locals locals;\n";
+  for (const auto& local : *tmpl.locals) {
+    out << "    locals." << local.name << " = &bindVar<" << local.type << ">(vars, \"" << local.name << "\");\n";
+  }
+  out << "    return locals;\n"
+      << "  }\n"
+      << "};\n\n"
+      << chunks.str()
+      << "struct View : Scope {\n"
+      << "  using Scope::Scope;\n\n"
+      << "  void render(const Locals& locals, OutputBuffer& out) {\n"
+      << "    (void)locals;\n"
+      << body.str()
+      << "#line __GENERATED__\n"
+      << "  }\n"
+      << "};\n\n"
+      << "void render(Cyclone::ViewContext& context, OutputBuffer& out) {\n"
+      << "  View view(context, out);\n"
+      << "  view.render(Locals::bind(context.vars()), out);\n"
+      << "}\n\n";
+
+  // Collection rendering: bind the frame once, then rebind only the item
+  // variable for each element of the collection.
+  out << "bool renderEach(Cyclone::ViewContext& context, std::string_view as, const std::type_info& type,\n"
+      << "                const void* items, OutputBuffer& out) {\n"
+      << "  View view(context, out);\n"
+      << "  auto locals = Locals::bind(context.vars());\n";
+  if (tmpl.locals->empty()) {
+    out << "  (void)locals;\n";
+  }
+  out << "\n";
+  for (const auto& local : *tmpl.locals) {
+    out << "  if (as == \"" << local.name << "\" && type == typeid(std::vector<" << local.type << ">)) {\n"
+        << "    for (const auto& item : *static_cast<const std::vector<" << local.type << ">*>(items)) {\n"
+        << "      locals." << local.name << " = &item;\n"
+        << "      view.render(locals, out);\n"
+        << "    }\n"
+        << "    return true;\n"
+        << "  }\n\n";
+  }
+  out << "  return false;\n"
+      << "}\n\n"
+      << "const Registration registration{\"" << tmpl.name << "\", &render, &renderEach};\n\n"
+      << "} // namespace CompiledViews::" << ns << "\n";
+
+  // Point diagnostics in the generated tail back at the generated file
+  std::istringstream lines(out.str());
+  std::ostringstream result;
+  std::string line;
+  for (int number = 1; std::getline(lines, line); number++) {
+    if (line == "#line __GENERATED__") {
+      line = "#line " + std::to_string(number + 1) + " \"" + ns + ".cpp\"";
+    }
+    result << line << "\n";
+  }
+
+  return result.str();
+}
+
+void writeIfChanged(const fs::path& path, const std::string& contents) {
+  {
+    std::ifstream existing(path, std::ios::binary);
+    if (existing) {
+      std::stringstream buffer;
+      buffer << existing.rdbuf();
+      if (buffer.str() == contents) return;  // Keep mtime so the build stays incremental
+    }
+  }
+
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  if (!out) {
+    throw std::runtime_error("cannot write " + path.string());
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fs::path root = "app/views";
+  fs::path outDir = "gen/views";
+  std::vector<fs::path> inputs;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--root" && i + 1 < argc) {
+      root = argv[++i];
+    } else if (arg == "--out" && i + 1 < argc) {
+      outDir = argv[++i];
+    } else {
+      inputs.emplace_back(arg);
+    }
+  }
+
+  int compiled = 0;
+  int skipped = 0;
+
+  try {
+    for (const auto& input : inputs) {
+      auto tmpl = parseTemplate(input, root);
+
+      if (!tmpl.locals) {
+        skipped++;
+        continue;
+      }
+
+      writeIfChanged(outDir / (identifierFor(tmpl.name) + ".cpp"), generate(tmpl));
+      compiled++;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "cyc_compile: " << e.what() << "\n";
+    return 1;
+  }
+
+  std::cout << "cyc_compile: " << compiled << " compiled, "
+            << skipped << " left to the interpreter (no <%@ locals %> directive)\n";
+  return 0;
+}
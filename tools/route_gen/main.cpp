@@ -0,0 +1,131 @@
+// route_gen: build-time generator for the radix route table
+//
+// Runs configureRoutes() against a fresh router, merges the expanded route
+// list into a Routing::RadixTrieBuilder and writes the flattened trie as
+// constexpr arrays:
+//
+//   namespace Routing::Generated {
+//     inline constexpr uint64_t kRouteFingerprint = ...;
+//     inline constexpr char kLabels[] = "/posts/new/edit...";
+//     inline constexpr FlatNode kNodes[] = {...};
+//   }
+//
+// RadixDispatcher picks the table up through __has_include and uses it as is
+// when the fingerprint matches the routes registered at startup.
+//
+// Usage: route_gen --out gen/routes/route_table.hpp
+
+#include "cyclone/routing.hpp"
+#include "config/routes.hpp"
+#include "routing/radix_trie.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string escape(std::string_view text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+std::string generate(const Routing::FlatTable& table, uint64_t fingerprint, size_t routeCount) {
+  std::ostringstream out;
+
+  out << "// Generated by tools/route_gen from config/routes.hpp; do not edit.\n"
+      << "// " << routeCount << " routes, " << table.nodes().size() << " trie nodes\n\n"
+      << "#pragma once\n\n"
+      << "#include \"routing/radix_trie.hpp\"\n\n"
+      << "namespace Routing::Generated {\n\n"
+      << "inline constexpr uint64_t kRouteFingerprint = " << fingerprint << "ULL;\n\n"
+      << "inline constexpr char kLabels[] = \"" << escape(table.labels()) << "\";\n\n"
+      << "inline constexpr FlatNode kNodes[] = {\n";
+
+  for (const auto& node : table.nodes()) {
+    out << "  {" << node.labelOffset << ", " << node.labelLength << ", "
+        << node.firstChild << ", " << node.childCount << ", "
+        << node.integerParam << ", " << node.stringParam << ", {";
+    for (size_t i = 0; i < node.routes.size(); ++i) {
+      out << (i ? ", " : "") << node.routes[i];
+    }
+    out << "}},\n";
+  }
+
+  out << "};\n\n"
+      << "} // namespace Routing::Generated\n";
+  return out.str();
+}
+
+void writeIfChanged(const fs::path& path, const std::string& contents) {
+  {
+    std::ifstream existing(path, std::ios::binary);
+    if (existing) {
+      std::stringstream buffer;
+      buffer << existing.rdbuf();
+      if (buffer.str() == contents) return;  // Keep mtime so the build stays incremental
+    }
+  }
+
+  if (path.has_parent_path()) {
+    fs::create_directories(path.parent_path());
+  }
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  if (!out) {
+    throw std::runtime_error("cannot write " + path.string());
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fs::path outPath = "gen/routes/route_table.hpp";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc) {
+      outPath = argv[++i];
+    }
+  }
+
+  try {
+    Cyclone::Router router;
+    configureRoutes(router);
+
+    const auto& routes = router.routes();
+    std::vector<std::pair<Routing::Method, std::string_view>> entries;
+    Routing::RadixTrieBuilder builder;
+
+    for (size_t i = 0; i < routes.size(); ++i) {
+      auto method = Routing::parseMethod(routes[i].method);
+      if (!method) {
+        throw std::runtime_error("unsupported HTTP method " + routes[i].method + " for " + routes[i].path);
+      }
+      entries.emplace_back(*method, routes[i].path);
+      builder.add(*method, routes[i].path, static_cast<int32_t>(i));
+    }
+
+    auto table = builder.build();
+    writeIfChanged(outPath, generate(table, Routing::routeFingerprint(entries), routes.size()));
+
+    std::cout << "route_gen: " << routes.size() << " routes, "
+              << table.nodes().size() << " trie nodes\n";
+  } catch (const std::exception& e) {
+    std::cerr << "route_gen: " << e.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}